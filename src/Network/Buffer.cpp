@@ -1,4 +1,5 @@
 #include "Buffer.h"
+#include "Util/DeferredRelease.h"
 
 namespace JCToolKit
 {
@@ -15,7 +16,8 @@ namespace JCToolKit
         // auto ret = packet_pool.obtain();
         // ret->setSize(0);
         // return ret;
-        return Ptr(new BufferRaw);
+        //在事件循环线程创建的缓存被其他线程最后释放时，转回创建线程释放
+        return makeHomeShared(new BufferRaw);
     }
 
     bool BufferList::empty()
@@ -3,6 +3,8 @@
 #include <string>
 #include <string.h>
 #include <memory>
+#include <vector>
+#include <sys/uio.h>
 #include "Util/List.h"
 #include "Util/Utilities.h"
 #include "Util/ReusePool.h"
@@ -57,9 +59,9 @@ namespace JCToolKit
             return _size;
         }
 
-        string toString() const override
+        std::string toString() const override
         {
-            return string(data(), size());
+            return std::string(data(), size());
         }
 
     private:
@@ -15,7 +15,7 @@ namespace JCToolKit
         return buf;
     }
 
-    int SocketHandler::setCloseWait(int sock, int second = 0)
+    int SocketHandler::setCloseWait(int sock, int second)
     {
         linger m_slinger;
         m_slinger.l_onoff = (second > 0);
@@ -145,11 +145,19 @@ namespace JCToolKit
         return ret;
     }
 
+    static std::atomic<bool> s_dns_cache_per_thread(false);
+
     class DNSCache
     {
     public:
+        //按线程缓存时各线程的互斥锁与缓存表互不共享，代价是每个线程各自解析一次
         static DNSCache &instance()
         {
+            if (s_dns_cache_per_thread.load(std::memory_order_relaxed))
+            {
+                static thread_local DNSCache s_thread_instance;
+                return s_thread_instance;
+            }
             static DNSCache instance;
             return instance;
         }
@@ -174,8 +182,8 @@ namespace JCToolKit
         }
 
     private:
-        DNSCache();
-        ~DNSCache();
+        DNSCache() {}
+        ~DNSCache() {}
 
         class DNSUnit
         {
@@ -233,6 +241,11 @@ namespace JCToolKit
         std::unordered_map<std::string, DNSUnit> _DNSMap;
     };
 
+    void SocketHandler::setDNSCachePerThread(bool perThread)
+    {
+        s_dns_cache_per_thread = perThread;
+    }
+
     bool SocketHandler::getDomainIP(const char *host, uint16_t port, sockaddr &addr)
     {
         bool hasIP = DNSCache::instance().getDomainIP(host, addr);
@@ -243,7 +256,7 @@ namespace JCToolKit
         return hasIP;
     }
 
-    int SocketHandler::connect(const char *host, uint16_t port, bool isAsync = true, const char *localIp = "0.0.0.0", uint16_t localPort = (uint16_t)0U)
+    int SocketHandler::connect(const char *host, uint16_t port, bool isAsync, const char *localIp, uint16_t localPort)
     {
         sockaddr addr;
         if (!DNSCache::instance().getDomainIP(host, addr))
@@ -149,6 +149,12 @@ namespace JCToolKit
      */
         static bool getDomainIP(const char *host, uint16_t port, struct sockaddr &addr);
 
+        /**
+     * 设置dns缓存是否按线程隔离，默认全局共享
+     * @param perThread 为true时每个线程使用独立的缓存，解析不再争抢全局锁
+     */
+        static void setDNSCachePerThread(bool perThread);
+
         /**
      * 设置组播ttl
      * @param sock socket fd号
@@ -0,0 +1,308 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <functional>
+#include "EventPoller.h"
+#include "Util/Utilities.h"
+#include "Util/UniqueFunction.h"
+
+namespace JCToolKit
+{
+    //批量聚合统计
+    class BatcherStatistic
+    {
+    public:
+        uint64_t _items = 0;          //已刷出的数据个数
+        uint64_t _flushes = 0;        //刷出次数
+        uint64_t _flushBySize = 0;    //因数据个数达到上限刷出的次数
+        uint64_t _flushByBytes = 0;   //因字节数达到上限刷出的次数
+        uint64_t _flushByTime = 0;    //因等待超时刷出的次数
+        uint64_t _totalLatencyUs = 0; //每批首个数据从加入到刷出的耗时之和
+        uint64_t _maxLatencyUs = 0;   //最大刷出延时
+
+        double avgBatchSize() const
+        {
+            return _flushes ? (double)_items / _flushes : 0;
+        }
+
+        double avgLatencyUs() const
+        {
+            return _flushes ? (double)_totalLatencyUs / _flushes : 0;
+        }
+    };
+
+    /**
+     * 绑定在EventPoller上的批量聚合器，将逐个产生的数据攒成批后一次性交给消费回调，
+     * 把每个数据一次的开销(如系统调用)摊薄为每批一次
+     * 数据个数、字节数、等待时间任一达到上限即刷出；在poller线程中add无锁，
+     * 其他线程调用add时每个数据都要切换一次poller线程，跨线程生产时应先在本地攒好再调用addBatch
+     * 超时由poller的定时任务驱动，精度为毫秒；每批只在首个数据到来时启动一次定时任务
+     * 析构时未刷出的数据被丢弃，需要时先调用flush
+     */
+    template <typename T>
+    class Batcher : public std::enable_shared_from_this<Batcher<T> >
+    {
+    public:
+        typedef std::shared_ptr<Batcher> Ptr;
+        typedef unique_function<void(std::vector<T> &items)> FlushCallBack;
+        typedef std::function<size_t(const T &item)> SizeFunction;
+
+        /**
+         * 创建聚合器
+         * @param poller 所在的EventPoller，消费回调在该poller线程中执行
+         * @param onFlush 消费回调，回调后items被清空，可以swap走其中的数据
+         * @param maxItems 每批最多数据个数，0为不限制
+         * @param maxDelayUs 每批首个数据最长等待时间(微秒)，0为不限制
+         * @param maxBytes 每批最多字节数，0为不限制
+         * @param sizeOf 计算单个数据字节数，maxBytes不为0时必须提供
+         */
+        static Ptr create(const EventPoller::Ptr &poller, FlushCallBack onFlush, size_t maxItems, uint64_t maxDelayUs,
+                          size_t maxBytes = 0, SizeFunction sizeOf = nullptr)
+        {
+            return Ptr(new Batcher(poller, std::move(onFlush), maxItems, maxDelayUs, maxBytes, std::move(sizeOf)));
+        }
+
+        //加入一个数据；非poller线程中调用时每个数据投递一次任务
+        void add(T item)
+        {
+            if (!_poller->isCurrentThread())
+            {
+                std::weak_ptr<Batcher> weakSelf = this->shared_from_this();
+                _poller->async(std::bind([weakSelf](T &item) {
+                    auto strongSelf = weakSelf.lock();
+                    if (strongSelf)
+                    {
+                        strongSelf->add_l(std::move(item));
+                    }
+                }, std::move(item)), false);
+                return;
+            }
+            add_l(std::move(item));
+        }
+
+        //加入一组数据，非poller线程中调用时整组只投递一次任务，仍按单个数据检查刷出条件
+        void addBatch(std::vector<T> items)
+        {
+            if (items.empty())
+            {
+                return;
+            }
+            if (!_poller->isCurrentThread())
+            {
+                std::weak_ptr<Batcher> weakSelf = this->shared_from_this();
+                _poller->async(std::bind([weakSelf](std::vector<T> &items) {
+                    auto strongSelf = weakSelf.lock();
+                    if (strongSelf)
+                    {
+                        strongSelf->addBatch_l(items);
+                    }
+                }, std::move(items)), false);
+                return;
+            }
+            addBatch_l(items);
+        }
+
+        //立即刷出当前批次
+        void flush()
+        {
+            if (!_poller->isCurrentThread())
+            {
+                std::weak_ptr<Batcher> weakSelf = this->shared_from_this();
+                _poller->async([weakSelf]() {
+                    auto strongSelf = weakSelf.lock();
+                    if (strongSelf)
+                    {
+                        strongSelf->flush_l(FLUSH_MANUAL);
+                    }
+                }, false);
+                return;
+            }
+            flush_l(FLUSH_MANUAL);
+        }
+
+        //可在任意线程调用，各字段分别读取，彼此之间不保证一致
+        BatcherStatistic getStatistic() const
+        {
+            BatcherStatistic ret;
+            ret._items = _items.load(std::memory_order_relaxed);
+            ret._flushes = _flushes.load(std::memory_order_relaxed);
+            ret._flushBySize = _flushBySize.load(std::memory_order_relaxed);
+            ret._flushByBytes = _flushByBytes.load(std::memory_order_relaxed);
+            ret._flushByTime = _flushByTime.load(std::memory_order_relaxed);
+            ret._totalLatencyUs = _totalLatencyUs.load(std::memory_order_relaxed);
+            ret._maxLatencyUs = _maxLatencyUs.load(std::memory_order_relaxed);
+            return ret;
+        }
+
+        const EventPoller::Ptr &getPoller() const
+        {
+            return _poller;
+        }
+
+    private:
+        typedef enum
+        {
+            FLUSH_MANUAL = 0,
+            FLUSH_SIZE,
+            FLUSH_BYTES,
+            FLUSH_TIME,
+        } FlushReason;
+
+        Batcher(const EventPoller::Ptr &poller, FlushCallBack onFlush, size_t maxItems, uint64_t maxDelayUs,
+                size_t maxBytes, SizeFunction sizeOf)
+            : _poller(poller), _onFlush(std::move(onFlush)), _maxItems(maxItems), _maxDelayUs(maxDelayUs),
+              _maxBytes(sizeOf ? maxBytes : 0), _sizeOf(std::move(sizeOf))
+        {
+            if (_maxItems)
+            {
+                _batch.reserve(_maxItems);
+            }
+        }
+
+        void add_l(T item)
+        {
+            if (_batch.empty())
+            {
+                _firstUs = getCurrentMicrosecond();
+                armTimer();
+            }
+            if (_maxBytes)
+            {
+                _bytes += _sizeOf(item);
+            }
+            _batch.emplace_back(std::move(item));
+            if (_maxItems && _batch.size() >= _maxItems)
+            {
+                flush_l(FLUSH_SIZE);
+            }
+            else if (_maxBytes && _bytes >= _maxBytes)
+            {
+                flush_l(FLUSH_BYTES);
+            }
+        }
+
+        void addBatch_l(std::vector<T> &items)
+        {
+            for (auto &item : items)
+            {
+                add_l(std::move(item));
+            }
+        }
+
+        void flush_l(FlushReason reason)
+        {
+            if (_batch.empty())
+            {
+                return;
+            }
+            auto latency = getCurrentMicrosecond() - _firstUs;
+            _items.fetch_add(_batch.size(), std::memory_order_relaxed);
+            _flushes.fetch_add(1, std::memory_order_relaxed);
+            _totalLatencyUs.fetch_add(latency, std::memory_order_relaxed);
+            if (latency > _maxLatencyUs.load(std::memory_order_relaxed))
+            {
+                _maxLatencyUs.store(latency, std::memory_order_relaxed);
+            }
+            switch (reason)
+            {
+            case FLUSH_SIZE:
+                _flushBySize.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case FLUSH_BYTES:
+                _flushByBytes.fetch_add(1, std::memory_order_relaxed);
+                break;
+            case FLUSH_TIME:
+                _flushByTime.fetch_add(1, std::memory_order_relaxed);
+                break;
+            default:
+                break;
+            }
+
+            //先换出当前批次，回调中再次add时进入新的批次
+            std::vector<T> batch;
+            batch.swap(_batch);
+            _bytes = 0;
+            if (_maxItems)
+            {
+                _batch.reserve(_maxItems);
+            }
+            try
+            {
+                _onFlush(batch);
+            }
+            catch (std::exception &ex)
+            {
+                printf("Batcher刷出捕获到异常: %s \n", ex.what());
+            }
+        }
+
+        //定时任务到期时若当前批次尚未超时则顺延，批次为空时停止，避免每批都重新创建定时任务
+        void armTimer()
+        {
+            if (!_maxDelayUs || _timerArmed)
+            {
+                return;
+            }
+            _timerArmed = true;
+            std::weak_ptr<Batcher> weakSelf = this->shared_from_this();
+            CancelToken::Scope scope(nullptr);
+            _poller->startDelayOperation(toDelayMs(_maxDelayUs), [weakSelf]() -> uint64_t {
+                auto strongSelf = weakSelf.lock();
+                if (!strongSelf)
+                {
+                    return 0;
+                }
+                return strongSelf->onTimer();
+            });
+        }
+
+        uint64_t onTimer()
+        {
+            if (_batch.empty())
+            {
+                _timerArmed = false;
+                return 0;
+            }
+            auto deadline = _firstUs + _maxDelayUs;
+            auto now = getCurrentMicrosecond();
+            if (deadline > now)
+            {
+                return toDelayMs(deadline - now);
+            }
+            //回调中再次add时会重新启动定时任务
+            _timerArmed = false;
+            flush_l(FLUSH_TIME);
+            return 0;
+        }
+
+        //定时任务精度为毫秒，向上取整
+        static uint64_t toDelayMs(uint64_t us)
+        {
+            return (us + 999) / 1000;
+        }
+
+    private:
+        EventPoller::Ptr _poller;
+        FlushCallBack _onFlush;
+        size_t _maxItems;
+        uint64_t _maxDelayUs;
+        size_t _maxBytes;
+        SizeFunction _sizeOf;
+
+        //以下只在poller线程访问
+        std::vector<T> _batch;
+        size_t _bytes = 0;
+        uint64_t _firstUs = 0;
+        bool _timerArmed = false;
+
+        std::atomic<uint64_t> _items{0};
+        std::atomic<uint64_t> _flushes{0};
+        std::atomic<uint64_t> _flushBySize{0};
+        std::atomic<uint64_t> _flushByBytes{0};
+        std::atomic<uint64_t> _flushByTime{0};
+        std::atomic<uint64_t> _totalLatencyUs{0};
+        std::atomic<uint64_t> _maxLatencyUs{0};
+    };
+}
@@ -0,0 +1,290 @@
+#pragma once
+
+#include <cstdio>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <stdexcept>
+#include "EventPoller.h"
+#include "Pipe.h"
+#include "Network/SocketHandler.h"
+#include "Util/RingBuffer.h"
+#include "Util/UniqueFunction.h"
+
+namespace JCToolKit
+{
+    /**
+     * 有界通道，用于在执行器之间传递数据
+     * 发送端在任意线程调用send，通道满时返回false由调用者决定重试或丢弃；
+     * 接收端绑定在EventPoller上，通过管道fd唤醒，每次以批量的形式回调，
+     * 从空变为非空时才写管道，连续发送只唤醒一次
+     * Queue为MpmcRingBuffer时支持多生产者，为SpscRingBuffer时只允许单个发送线程
+     */
+    template <typename T, typename Queue = MpmcRingBuffer<T> >
+    class Channel
+    {
+    public:
+        typedef std::shared_ptr<Channel> Ptr;
+        typedef unique_function<void(std::vector<T> &items)> RecvCallBack;
+        typedef std::function<void()> FlowCallBack;
+        typedef std::function<void()> CloseCallBack;
+
+        /**
+         * 创建通道
+         * @param poller 接收端所在的EventPoller
+         * @param capacity 容量，向上取整为2的幂
+         * @param onRecv 接收回调，在poller线程中执行；为空时不注册唤醒，由调用者主动recv
+         * @param maxBatch 每次回调最多携带的数据个数
+         */
+        static Ptr create(const EventPoller::Ptr &poller, size_t capacity, RecvCallBack onRecv, size_t maxBatch = 64)
+        {
+            Ptr ret(new Channel(poller, capacity, maxBatch));
+            if (!onRecv)
+            {
+                return ret;
+            }
+            ret->_onRecv = std::move(onRecv);
+            ret->_wakeup = true;
+            std::weak_ptr<Channel> weakSelf = ret;
+            if (poller->addEvent(ret->_pipe->readFD(), PollEventRead, [weakSelf](int) {
+                    auto strongSelf = weakSelf.lock();
+                    if (strongSelf)
+                    {
+                        strongSelf->onPipeEvent();
+                    }
+                }) == -1)
+            {
+                throw std::runtime_error("Channel添加管道失败");
+            }
+            return ret;
+        }
+
+        ~Channel()
+        {
+            if (_wakeup)
+            {
+                //管道需等到从epoll中移除后再关闭
+                auto pipe = _pipe;
+                _poller->deleteEvent(pipe->readFD(), [pipe](bool) {});
+            }
+        }
+
+        //通道已满或已关闭时返回false，item不会被移动
+        template <typename U>
+        bool send(U &&item)
+        {
+            if (_closed.load(std::memory_order_acquire))
+            {
+                return false;
+            }
+            if (!_queue.push(std::forward<U>(item)))
+            {
+                onFull();
+                return false;
+            }
+            notify();
+            return true;
+        }
+
+        //批量发送，只唤醒一次，返回实际发送的个数
+        template <typename Iterator>
+        size_t sendBatch(Iterator begin, Iterator end)
+        {
+            size_t count = 0;
+            if (_closed.load(std::memory_order_acquire))
+            {
+                return count;
+            }
+            for (; begin != end; ++begin, ++count)
+            {
+                if (!_queue.push(std::move(*begin)))
+                {
+                    onFull();
+                    break;
+                }
+            }
+            if (count)
+            {
+                notify();
+            }
+            return count;
+        }
+
+        /**
+         * 主动接收，最多取出maxCount个数据追加到items中
+         * Queue为SpscRingBuffer时只能在唯一的接收线程中调用
+         * @return 取出的个数
+         */
+        size_t recv(std::vector<T> &items, size_t maxCount)
+        {
+            size_t count = 0;
+            T item;
+            while (count < maxCount && _queue.pop(item))
+            {
+                items.emplace_back(std::move(item));
+                ++count;
+            }
+            if (count < maxCount && _full.load(std::memory_order_relaxed) && _full.exchange(false))
+            {
+                //曾经满过的通道已被取空，通知发送端恢复发送
+                if (_onEmpty)
+                {
+                    _onEmpty();
+                }
+            }
+            return count;
+        }
+
+        /**
+         * 设置流控回调，需在开始收发前设置
+         * @param onFull 发送因通道满而失败时回调，在发送线程中执行，直到下次onEmpty前只回调一次
+         * @param onEmpty 满过的通道被取空时回调，在接收线程中执行
+         */
+        void setFlowCallBack(FlowCallBack onFull, FlowCallBack onEmpty)
+        {
+            _onFull = std::move(onFull);
+            _onEmpty = std::move(onEmpty);
+        }
+
+        /**
+         * 关闭通道，可在任意线程调用，此后send失败
+         * 接收端先收完关闭前已发送的数据，再在poller线程中回调onClose，只回调一次
+         * 与close并发的send是否在关闭前完成不确定，需要时由发送端自行同步
+         */
+        void close()
+        {
+            if (_closed.exchange(true))
+            {
+                return;
+            }
+            if (_wakeup)
+            {
+                //绕过_notified强制唤醒一次，保证接收端能看到关闭
+                _pipe->write("", 1);
+            }
+        }
+
+        bool isClosed() const
+        {
+            return _closed.load(std::memory_order_acquire);
+        }
+
+        //设置关闭回调，需在close之前设置
+        void setCloseCallBack(CloseCallBack onClose)
+        {
+            _onClose = std::move(onClose);
+        }
+
+        //近似值
+        size_t size() const
+        {
+            return _queue.size();
+        }
+
+        size_t capacity() const
+        {
+            return _queue.capacity();
+        }
+
+        //发送因通道满而失败的次数
+        uint64_t fullCount() const
+        {
+            return _fullCount.load();
+        }
+
+        const EventPoller::Ptr &getPoller() const
+        {
+            return _poller;
+        }
+
+    private:
+        Channel(const EventPoller::Ptr &poller, size_t capacity, size_t maxBatch)
+            : _poller(poller), _maxBatch(maxBatch ? maxBatch : 1), _queue(capacity), _pipe(std::make_shared<PipeWrapper>())
+        {
+            SocketHandler::setNoBlocked(_pipe->writeFD());
+        }
+
+        void onFull()
+        {
+            ++_fullCount;
+            if (!_full.exchange(true) && _onFull)
+            {
+                _onFull();
+            }
+        }
+
+        //只在通道从空变为非空时写管道
+        void notify()
+        {
+            if (_wakeup && !_notified.exchange(true))
+            {
+                _pipe->write("", 1);
+            }
+        }
+
+        void onPipeEvent()
+        {
+            char buffer[64];
+            while (_pipe->read(buffer, sizeof(buffer)) > 0)
+            {
+            }
+            //先清除标记再取数据，此后的发送要么被本次取到，要么重新唤醒
+            _notified.store(false);
+
+            std::vector<T> items;
+            items.reserve(_maxBatch);
+            while (recv(items, _maxBatch))
+            {
+                try
+                {
+                    _onRecv(items);
+                }
+                catch (std::exception &ex)
+                {
+                    printf("Channel执行接收回调捕获到异常: %s \n", ex.what());
+                }
+                items.clear();
+                if (_poller->shouldYield())
+                {
+                    //本轮事件循环已超时，剩余数据留到下一轮，避免饿死其他fd
+                    _notified.store(true);
+                    _pipe->write("", 1);
+                    return;
+                }
+            }
+
+            //关闭前发送的数据都已收完
+            if (_closed.load(std::memory_order_acquire) && !_queue.size() && !_closeNotified)
+            {
+                _closeNotified = true;
+                if (_onClose)
+                {
+                    _onClose();
+                }
+            }
+        }
+
+    private:
+        EventPoller::Ptr _poller;
+        size_t _maxBatch;
+        Queue _queue;
+        std::shared_ptr<PipeWrapper> _pipe;
+        bool _wakeup = false;
+        RecvCallBack _onRecv;
+        FlowCallBack _onFull;
+        FlowCallBack _onEmpty;
+        CloseCallBack _onClose;
+        //只在poller线程访问
+        bool _closeNotified = false;
+        std::atomic<bool> _closed{false};
+        std::atomic<bool> _notified{false};
+        std::atomic<bool> _full{false};
+        std::atomic<uint64_t> _fullCount{0};
+    };
+
+    template <typename T>
+    using SpscChannel = Channel<T, SpscRingBuffer<T> >;
+
+    template <typename T>
+    using MpmcChannel = Channel<T, MpmcRingBuffer<T> >;
+}
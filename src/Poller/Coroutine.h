@@ -0,0 +1,474 @@
+#pragma once
+
+#if defined(ENABLE_COROUTINE)
+
+#include <cstdio>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <coroutine>
+#include "EventPoller.h"
+#include "Thread/CancelToken.h"
+#include "Thread/OperationExecutor.h"
+#include "Util/ThreadLocalAllocator.h"
+
+namespace JCToolKit
+{
+    //协程帧分配器：按大小分级复用线程本地缓存，稳定运行后创建协程无需malloc
+    class CoroutineFrameAllocator
+    {
+    public:
+        static void *allocate(size_t size)
+        {
+            switch (sizeClass(size))
+            {
+            case 0:
+                return ThreadLocalBlockCache<128>::allocate();
+            case 1:
+                return ThreadLocalBlockCache<256>::allocate();
+            case 2:
+                return ThreadLocalBlockCache<512>::allocate();
+            case 3:
+                return ThreadLocalBlockCache<1024>::allocate();
+            case 4:
+                return ThreadLocalBlockCache<2048>::allocate();
+            case 5:
+                return ThreadLocalBlockCache<4096>::allocate();
+            default:
+                return ::operator new(size);
+            }
+        }
+
+        static void deallocate(void *ptr, size_t size)
+        {
+            switch (sizeClass(size))
+            {
+            case 0:
+                return ThreadLocalBlockCache<128>::deallocate(ptr);
+            case 1:
+                return ThreadLocalBlockCache<256>::deallocate(ptr);
+            case 2:
+                return ThreadLocalBlockCache<512>::deallocate(ptr);
+            case 3:
+                return ThreadLocalBlockCache<1024>::deallocate(ptr);
+            case 4:
+                return ThreadLocalBlockCache<2048>::deallocate(ptr);
+            case 5:
+                return ThreadLocalBlockCache<4096>::deallocate(ptr);
+            default:
+                ::operator delete(ptr);
+            }
+        }
+
+    private:
+        //128字节起按2的幂分级，超过4KB的协程帧直接走堆分配
+        static int sizeClass(size_t size)
+        {
+            int ret = 0;
+            for (size_t block = 128; block < size; block <<= 1)
+            {
+                if (++ret > 5)
+                {
+                    return -1;
+                }
+            }
+            return ret;
+        }
+    };
+
+    template <typename T = void>
+    class Task;
+
+    class TaskPromiseBase
+    {
+    public:
+        static void *operator new(size_t size)
+        {
+            return CoroutineFrameAllocator::allocate(size);
+        }
+
+        static void operator delete(void *ptr, size_t size)
+        {
+            CoroutineFrameAllocator::deallocate(ptr, size);
+        }
+
+        //Task在被co_await或start时才开始执行
+        std::suspend_always initial_suspend() noexcept
+        {
+            return {};
+        }
+
+        class FinalAwaiter
+        {
+        public:
+            bool await_ready() noexcept
+            {
+                return false;
+            }
+
+            //执行完毕后直接切换到等待者，分离运行的协程自行销毁
+            template <typename Promise>
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept
+            {
+                auto &promise = handle.promise();
+                if (promise._detached)
+                {
+                    if (promise._exception)
+                    {
+                        try
+                        {
+                            std::rethrow_exception(promise._exception);
+                        }
+                        catch (std::exception &ex)
+                        {
+                            printf("协程执行捕获到异常: %s \n", ex.what());
+                        }
+                        catch (...)
+                        {
+                        }
+                    }
+                    handle.destroy();
+                    return std::noop_coroutine();
+                }
+                if (promise._continuation)
+                {
+                    return promise._continuation;
+                }
+                return std::noop_coroutine();
+            }
+
+            void await_resume() noexcept {}
+        };
+
+        FinalAwaiter final_suspend() noexcept
+        {
+            return {};
+        }
+
+        void unhandled_exception()
+        {
+            _exception = std::current_exception();
+        }
+
+    public:
+        std::coroutine_handle<> _continuation;
+        std::exception_ptr _exception;
+        bool _detached = false;
+    };
+
+    template <typename T>
+    class TaskPromise : public TaskPromiseBase
+    {
+    public:
+        ~TaskPromise()
+        {
+            if (_hasValue)
+            {
+                reinterpret_cast<T *>(&_storage)->~T();
+            }
+        }
+
+        Task<T> get_return_object() noexcept;
+
+        template <typename U>
+        void return_value(U &&value)
+        {
+            new (&_storage) T(std::forward<U>(value));
+            _hasValue = true;
+        }
+
+        T result()
+        {
+            if (_exception)
+            {
+                std::rethrow_exception(_exception);
+            }
+            return std::move(*reinterpret_cast<T *>(&_storage));
+        }
+
+    private:
+        bool _hasValue = false;
+        typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+    };
+
+    template <>
+    class TaskPromise<void> : public TaskPromiseBase
+    {
+    public:
+        Task<void> get_return_object() noexcept;
+
+        void return_void() {}
+
+        void result()
+        {
+            if (_exception)
+            {
+                std::rethrow_exception(_exception);
+            }
+        }
+    };
+
+    /**
+     * 协程任务，惰性启动：被co_await时在等待者所在线程开始执行，执行完毕后在结束时所在线程恢复等待者
+     * 不被等待的任务通过start分离运行，执行完毕后自行销毁
+     * 挂起中的任务不能被销毁，否则唤醒时将访问已释放的协程帧
+     */
+    template <typename T>
+    class Task
+    {
+    public:
+        typedef TaskPromise<T> promise_type;
+        typedef std::coroutine_handle<promise_type> Handle;
+
+        explicit Task(Handle handle) : _handle(handle) {}
+
+        Task(Task &&that) noexcept : _handle(that._handle)
+        {
+            that._handle = nullptr;
+        }
+
+        Task &operator=(Task &&that) noexcept
+        {
+            if (this != &that)
+            {
+                if (_handle)
+                {
+                    _handle.destroy();
+                }
+                _handle = that._handle;
+                that._handle = nullptr;
+            }
+            return *this;
+        }
+
+        ~Task()
+        {
+            if (_handle)
+            {
+                _handle.destroy();
+            }
+        }
+
+        //在当前线程开始分离运行，异常被捕获并打印
+        void start()
+        {
+            auto handle = _handle;
+            _handle = nullptr;
+            handle.promise()._detached = true;
+            handle.resume();
+        }
+
+        class Awaiter
+        {
+        public:
+            explicit Awaiter(Handle handle) : _handle(handle) {}
+
+            bool await_ready() noexcept
+            {
+                return _handle.done();
+            }
+
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> continuation) noexcept
+            {
+                _handle.promise()._continuation = continuation;
+                return _handle;
+            }
+
+            T await_resume()
+            {
+                return _handle.promise().result();
+            }
+
+        private:
+            Handle _handle;
+        };
+
+        //已被移走或已start的Task不能再被等待
+        Awaiter operator co_await() &&
+        {
+            return Awaiter(checkHandle());
+        }
+
+        Awaiter operator co_await() &
+        {
+            return Awaiter(checkHandle());
+        }
+
+    private:
+        Handle checkHandle() const
+        {
+            if (!_handle)
+            {
+                throw std::logic_error("co_await an empty Task");
+            }
+            return _handle;
+        }
+
+    private:
+        Task(const Task &) = delete;
+        Task &operator=(const Task &) = delete;
+
+    private:
+        Handle _handle;
+    };
+
+    template <typename T>
+    inline Task<T> TaskPromise<T>::get_return_object() noexcept
+    {
+        return Task<T>(std::coroutine_handle<TaskPromise<T> >::from_promise(*this));
+    }
+
+    inline Task<void> TaskPromise<void>::get_return_object() noexcept
+    {
+        return Task<void>(std::coroutine_handle<TaskPromise<void> >::from_promise(*this));
+    }
+
+    //切换到执行器线程继续执行
+    class ScheduleAwaiter
+    {
+    public:
+        explicit ScheduleAwaiter(OperationExecutorProtocol *executor) : _executor(executor) {}
+
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            //唤醒任务不能随CancelToken取消，否则协程将永远挂起
+            CancelToken::Scope scope(nullptr);
+            _executor->async([handle]() {
+                handle.resume();
+            }, false);
+        }
+
+        void await_resume() noexcept {}
+
+    private:
+        OperationExecutorProtocol *_executor;
+    };
+
+    inline ScheduleAwaiter OperationExecutorProtocol::schedule()
+    {
+        return ScheduleAwaiter(this);
+    }
+
+    //在poller线程中休眠指定毫秒数后继续执行
+    class SleepAwaiter
+    {
+    public:
+        SleepAwaiter(EventPoller *poller, uint64_t delayMs) : _poller(poller), _delayMs(delayMs) {}
+
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        void await_suspend(std::coroutine_handle<> handle)
+        {
+            CancelToken::Scope scope(nullptr);
+            _poller->startDelayOperation(_delayMs, [handle]() -> uint64_t {
+                handle.resume();
+                return 0;
+            });
+        }
+
+        void await_resume() noexcept {}
+
+    private:
+        EventPoller *_poller;
+        uint64_t _delayMs;
+    };
+
+    inline SleepAwaiter EventPoller::sleep(uint64_t delayMs)
+    {
+        return SleepAwaiter(this, delayMs);
+    }
+
+    /**
+     * 等待fd可读或可写，在poller线程中恢复，返回实际触发的PollEvent
+     * 每次等待以水平触发方式注册、触发后立即注销，注册前已就绪的事件不会丢失；
+     * 同一个fd同一时刻只能有一个等待者，且不能已通过addEvent注册到该poller
+     */
+    class IoAwaiter
+    {
+    public:
+        IoAwaiter(const EventPoller::Ptr &poller, int fd, int event) : _poller(poller), _fd(fd), _event(event) {}
+
+        bool await_ready() noexcept
+        {
+            return false;
+        }
+
+        bool await_suspend(std::coroutine_handle<> handle)
+        {
+            CancelToken::Scope scope(nullptr);
+            if (_poller->isCurrentThread())
+            {
+                //注册失败时直接返回错误事件，不挂起
+                return regist(handle);
+            }
+            //非poller线程中addEvent只是排队注册，得不到注册结果，需切换到poller线程注册，失败时以错误事件恢复
+            auto self = this;
+            _poller->async([self, handle]() {
+                if (!self->regist(handle))
+                {
+                    handle.resume();
+                }
+            }, false);
+            return true;
+        }
+
+        int await_resume() noexcept
+        {
+            return _event;
+        }
+
+    private:
+        //在poller线程中注册，失败时返回false并置为错误事件；挂起期间本对象位于协程帧中，回调可访问
+        bool regist(std::coroutine_handle<> handle)
+        {
+            auto poller = _poller;
+            auto fd = _fd;
+            auto event = &_event;
+            auto ret = _poller->addEvent(_fd, _event | PollEventError | PollEventLT, [poller, fd, event, handle](int trigger) {
+                poller->deleteEvent(fd);
+                *event = trigger;
+                handle.resume();
+            });
+            if (ret == -1)
+            {
+                _event = PollEventError;
+                return false;
+            }
+            return true;
+        }
+
+    private:
+        EventPoller::Ptr _poller;
+        int _fd;
+        int _event;
+    };
+
+    //poller为空时使用当前线程所属的poller，不在poller线程中则从EventPollerPool中选取
+    inline IoAwaiter readable(int fd, EventPoller::Ptr poller = nullptr)
+    {
+        if (!poller)
+        {
+            poller = EventPollerPool::Instance().getPoller();
+        }
+        return IoAwaiter(poller, fd, PollEventRead);
+    }
+
+    inline IoAwaiter writable(int fd, EventPoller::Ptr poller = nullptr)
+    {
+        if (!poller)
+        {
+            poller = EventPollerPool::Instance().getPoller();
+        }
+        return IoAwaiter(poller, fd, PollEventWrite);
+    }
+}
+
+#endif // ENABLE_COROUTINE
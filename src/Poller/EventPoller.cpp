@@ -11,6 +11,10 @@
 #endif
 
 #define EPOLL_SIZE 1024
+#define MAILBOX_SIZE 256
+#define RELEASE_QUEUE_SIZE 1024
+//退役后继续转交任务的宽限期，毫秒
+#define RETIRE_GRACE_MS 1000
 #define toEpoll(event) (((event)&PollEventRead) ? EPOLLIN : 0) | (((event)&PollEventWrite) ? EPOLLOUT : 0) | (((event)&PollEventError) ? (EPOLLHUP | EPOLLERR) : 0) | (((event)&PollEventLT) ? 0 : EPOLLET)
 #define toPoller(epoll_event) (((epoll_event)&EPOLLIN) ? PollEventRead : 0) | (((epoll_event)&EPOLLOUT) ? PollEventWrite : 0) | (((epoll_event)&EPOLLHUP) ? PollEventError : 0) | (((epoll_event)&EPOLLERR) ? PollEventError : 0)
 
@@ -34,7 +38,29 @@ namespace JCToolKit
             throw std::runtime_error(StrPrinter() << "创建epoll失败" << get_uv_errmsg(true));
         }
         SocketHandler::setCloExec(_epollFd);
+
+        _epollFdHigh = epoll_create(EPOLL_SIZE);
+        if (_epollFdHigh == -1)
+        {
+            throw std::runtime_error(StrPrinter() << "创建epoll失败" << get_uv_errmsg(true));
+        }
+        SocketHandler::setCloExec(_epollFdHigh);
+        struct epoll_event epollEvent = {0};
+        epollEvent.events = EPOLLIN;
+        epollEvent.data.fd = _epollFdHigh;
+        if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _epollFdHigh, &epollEvent) == -1)
+        {
+            throw std::runtime_error("epoll添加高优先级epoll失败");
+        }
 #endif
+        for (auto &limit : _ioClassLimit)
+        {
+            limit = 0;
+        }
+
+        _releaseQueue = ReleaseQueue::obtain(RELEASE_QUEUE_SIZE, [this]() {
+            _pipe.write("", 1);
+        });
 
         _loopThreadID = std::this_thread::get_id();
         if (addEvent(_pipe.readFD(), PollEventRead, [this](int event) { onPipeEvent(); }) == -1)
@@ -45,10 +71,14 @@ namespace JCToolKit
 
     void EventPoller::shutdown()
     {
-        async_l([]() {
-            throw ExitException();
-        },
-                false, true);
+        CancelToken::Scope scope(nullptr);
+        if (!_retireDone)
+        {
+            async_l([]() {
+                throw ExitException();
+            },
+                    false, true);
+        }
 
         if (_loopThread)
         {
@@ -82,42 +112,66 @@ namespace JCToolKit
             close(_epollFd);
             _epollFd = -1;
         }
+        if (_epollFdHigh != -1)
+        {
+            close(_epollFdHigh);
+            _epollFdHigh = -1;
+        }
 #endif
         _loopThreadID = std::this_thread::get_id();
+        _releaseQueue->close();
+        onMailbox();
         onPipeEvent();
+        for (size_t i = 0; i < _mailboxCount; ++i)
+        {
+            delete _mailboxes[i].load();
+        }
+        ReleaseQueue::recycle(_releaseQueue);
     }
 
-    int EventPoller::addEvent(int fd, int event, PollEventCallBack callBack)
+    int EventPoller::addEvent(int fd, int event, PollEventCallBack callBack, IOClass ioClass)
     {
         if (!callBack)
         {
             return -1;
         }
 
+        auto next = successor();
+        if (next)
+        {
+            return next->addEvent(fd, event, std::move(callBack), ioClass);
+        }
+
         if (isCurrentThread())
         {
 #if defined(HAS_EPOLL)
             struct epoll_event epollEvent = {0};
             epollEvent.events = (toEpoll(event)) | EPOLLEXCLUSIVE;
             epollEvent.data.fd = fd;
-            int ret = epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &epollEvent);
+            int ret = epoll_ctl(ioClass == IO_CLASS_HIGH ? _epollFdHigh : _epollFd, EPOLL_CTL_ADD, fd, &epollEvent);
             if (ret == 0)
             {
                 _eventMap.emplace(fd, std::make_shared<PollEventCallBack>(std::move(callBack)));
+                if (ioClass == IO_CLASS_HIGH)
+                {
+                    ++_highEventCount;
+                }
             }
             return ret;
 #else
             PollRecord::Ptr record(new PollRecord);
             record->event = event;
+            record->ioClass = ioClass;
             record->callBack = std::move(callBack);
             _eventMap.emplace(fd, record);
             return 0;
 #endif
         }
 
-        async([this, fd, event, callBack]() {
-            addEvent(fd, event, std::move(const_cast<PollEventCallBack &>(callBack)));
-        });
+        //c++11不支持移动捕获，通过bind转移只可移动的回调
+        async(std::bind([this, fd, event, ioClass](PollEventCallBack &callBack) {
+            addEvent(fd, event, std::move(callBack), ioClass);
+        }, std::move(callBack)));
 
         return 0;
     }
@@ -129,10 +183,27 @@ namespace JCToolKit
             callBack = [](bool success) {};
         }
 
+        auto next = successor();
+        if (next)
+        {
+            return next->deleteEvent(fd, std::move(callBack));
+        }
+
         if (isCurrentThread())
         {
 #if defined(HAS_EPOLL)
-            bool success = epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL) == 0 && _eventMap.erase(fd) > 0;
+            //不记录fd的优先级，普通epoll中没有时再从高优先级epoll中删除
+            bool success = false;
+            if (epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL) == 0)
+            {
+                success = true;
+            }
+            else if (epoll_ctl(_epollFdHigh, EPOLL_CTL_DEL, fd, NULL) == 0)
+            {
+                success = true;
+                --_highEventCount;
+            }
+            success = success && _eventMap.erase(fd) > 0;
             callBack(success);
             return success ? 0 : -1;
 #else
@@ -141,20 +212,32 @@ namespace JCToolKit
 #endif
         }
 
-        async([this, fd, callBack]() {
-            deleteEvent(fd, std::move(const_cast<PollDeleteCallBack &>(callBack)));
-        });
+        //删除事件必须执行，不受当前CancelToken影响
+        CancelToken::Scope scope(nullptr);
+        async(std::bind([this, fd](PollDeleteCallBack &callBack) {
+            deleteEvent(fd, std::move(callBack));
+        }, std::move(callBack)));
 
         return 0;
     }
 
     int EventPoller::modifyEvent(int fd, int event)
     {
+        auto next = successor();
+        if (next)
+        {
+            return next->modifyEvent(fd, event);
+        }
+
 #if defined(HAS_EPOLL)
         struct epoll_event epollEvent = {0};
         epollEvent.events = toEpoll(event);
         epollEvent.data.fd = fd;
-        return epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &epollEvent);
+        if (epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &epollEvent) == 0)
+        {
+            return 0;
+        }
+        return epoll_ctl(_epollFdHigh, EPOLL_CTL_MOD, fd, &epollEvent);
 #else
         if (isCurrentThread())
         {
@@ -174,11 +257,21 @@ namespace JCToolKit
 
     Operation::Ptr EventPoller::async(OperationFunction op, bool maySync)
     {
+        auto next = successor();
+        if (next)
+        {
+            return next->async(std::move(op), maySync);
+        }
         return async_l(std::move(op), maySync, false);
     }
 
     Operation::Ptr EventPoller::asyncFirst(OperationFunction op, bool maySync)
     {
+        auto next = successor();
+        if (next)
+        {
+            return next->asyncFirst(std::move(op), maySync);
+        }
         return async_l(std::move(op), maySync, true);
     }
 
@@ -190,28 +283,218 @@ namespace JCToolKit
             return nullptr;
         }
 
-        auto ret = std::make_shared<Operation>(std::move(op));
+        auto ret = Operation::create(std::move(op));
+        if (!first && postMailbox(ret))
+        {
+            return ret;
+        }
+
+        auto nowMs = getCurrentMillisecond();
         {
             std::lock_guard<std::mutex> lck(_mtxOperation);
+            markEnqueue(nowMs);
             if (first)
             {
-                _operationList.emplace_front(op);
+                _operationList.emplace_front(ret);
             }
             else
             {
-                _operationList.emplace_back(op);
+                _operationList.emplace_back(ret);
+            }
+        }
+
+        _pipe.write("", 1);
+        return ret;
+    }
+
+    std::vector<Operation::Ptr> EventPoller::asyncBatch(std::vector<OperationFunction> operations, bool maySync, bool contiguous)
+    {
+        auto next = successor();
+        if (next)
+        {
+            return next->asyncBatch(std::move(operations), maySync, contiguous);
+        }
+
+        if (maySync && isCurrentThread())
+        {
+            for (auto &operation : operations)
+            {
+                operation();
+            }
+            return std::vector<Operation::Ptr>();
+        }
+
+        auto ret = createOperations(operations, contiguous);
+        if (ret.empty())
+        {
+            return ret;
+        }
+
+        //同池poller线程的批量任务与其async同样走信箱，保持同一来源的投递顺序
+        if (postMailbox(ret.front()))
+        {
+            for (size_t i = 1; i < ret.size(); ++i)
+            {
+                postMailbox(ret[i]);
             }
+            return ret;
+        }
+
+        //在锁外构造链表，加锁后直接拼接
+        decltype(_operationList) batch;
+        for (auto &operation : ret)
+        {
+            batch.emplace_back(operation);
+        }
+        auto nowMs = getCurrentMillisecond();
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            markEnqueue(nowMs);
+            _operationList.append(batch);
         }
 
         _pipe.write("", 1);
         return ret;
     }
 
+    Operation::Ptr EventPoller::asyncAdmit(OperationFunction op, AdmitPriority priority, AdmitResult *result, bool maySync)
+    {
+        auto next = successor();
+        if (next)
+        {
+            return next->asyncAdmit(std::move(op), priority, result, maySync);
+        }
+
+        if (result)
+        {
+            *result = ADMIT_OK;
+        }
+        if (maySync && isCurrentThread())
+        {
+            ++_admittedCount;
+            op();
+            return nullptr;
+        }
+
+        auto ret = Operation::create(std::move(op));
+        auto nowMs = getCurrentMillisecond();
+        //信箱中的任务同样计入队列深度与等待时间，只在需要按其准入时统计
+        auto pending = (priority != ADMIT_HIGH && _maxDepth.load(std::memory_order_relaxed)) ? mailboxSize() : 0;
+        auto pendingSinceMs = (priority != ADMIT_HIGH && _maxAgeMs.load(std::memory_order_relaxed)) ? mailboxOldestMs() : UINT64_MAX;
+        AdmitResult admit;
+        bool posted = false;
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            admit = checkAdmission(priority, nowMs, pending, pendingSinceMs);
+            //准入后同池poller线程的任务走信箱，与其async保持投递顺序
+            if (admit == ADMIT_OK && !(posted = postMailbox(ret)))
+            {
+                markEnqueue(nowMs);
+                _operationList.emplace_back(ret);
+            }
+        }
+
+        if (admit != ADMIT_OK)
+        {
+            //被拒绝的任务直接丢弃，由调用者决定是否快速失败
+            (admit == ADMIT_REJECT_DEPTH ? _shedDepthCount : _shedAgeCount)++;
+            if (priority == ADMIT_LOW)
+            {
+                ++_shedLowCount;
+            }
+            if (result)
+            {
+                *result = admit;
+            }
+            return nullptr;
+        }
+
+        ++_admittedCount;
+        if (!posted)
+        {
+            _pipe.write("", 1);
+        }
+        return ret;
+    }
+
+    EventPoller::AdmitResult EventPoller::checkAdmission(AdmitPriority priority, uint64_t nowMs, size_t pending, uint64_t pendingSinceMs)
+    {
+        if (priority == ADMIT_HIGH)
+        {
+            return ADMIT_OK;
+        }
+
+        //低优先级任务在达到限制的一半时即被拒绝，为普通任务预留余量
+        auto shift = priority == ADMIT_LOW ? 1 : 0;
+        auto maxDepth = _maxDepth.load(std::memory_order_relaxed) >> shift;
+        auto maxAgeMs = _maxAgeMs.load(std::memory_order_relaxed) >> shift;
+        if (_maxDepth.load(std::memory_order_relaxed) && _operationList.size() + pending >= maxDepth)
+        {
+            return ADMIT_REJECT_DEPTH;
+        }
+        //队首任务与信箱中最早的任务取较早者
+        auto oldestMs = _operationList.empty() ? pendingSinceMs : std::min(pendingSinceMs, _oldestEnqueueMs);
+        if (_maxAgeMs.load(std::memory_order_relaxed) && oldestMs != UINT64_MAX && nowMs >= oldestMs && nowMs - oldestMs >= maxAgeMs)
+        {
+            return ADMIT_REJECT_AGE;
+        }
+        return ADMIT_OK;
+    }
+
+    inline void EventPoller::markEnqueue(uint64_t nowMs)
+    {
+        if (_operationList.empty())
+        {
+            _oldestEnqueueMs = nowMs;
+        }
+    }
+
+    void EventPoller::setAdmissionLimit(size_t maxDepth, uint64_t maxAgeMs)
+    {
+        _maxDepth = maxDepth;
+        _maxAgeMs = maxAgeMs;
+    }
+
+    void EventPoller::setIOClassLimit(IOClass ioClass, size_t maxEvents)
+    {
+        if (ioClass < IO_CLASS_MAX)
+        {
+            _ioClassLimit[ioClass] = maxEvents;
+        }
+    }
+
+    int EventPoller::getIOClassLimit(IOClass ioClass)
+    {
+        size_t limit = _ioClassLimit[ioClass];
+        return (int)(limit && limit < EPOLL_SIZE ? limit : EPOLL_SIZE);
+    }
+
+    EventPoller::AdmissionStatistic EventPoller::getAdmissionStatistic() const
+    {
+        AdmissionStatistic ret;
+        ret._admitted = _admittedCount.load();
+        ret._shedDepth = _shedDepthCount.load();
+        ret._shedAge = _shedAgeCount.load();
+        ret._shedLow = _shedLowCount.load();
+        return ret;
+    }
+
     bool EventPoller::isCurrentThread()
     {
         return _loopThreadID == std::this_thread::get_id();
     }
 
+    void EventPoller::setAffinity(const std::vector<int> &cpus)
+    {
+        if (successor())
+        {
+            return;
+        }
+        async([cpus]() {
+            ThreadPool::setAffinity(cpus);
+        });
+    }
+
     inline void EventPoller::onPipeEvent()
     {
         char buffer[1024];
@@ -225,12 +508,24 @@ namespace JCToolKit
             error = get_uv_error(true);
         } while (error != UV_EAGAIN);
 
+        //管道中的唤醒可能来自信箱或延迟释放队列，读走后需再检查一次，否则将无人唤醒
+        onMailbox();
+        _releaseQueue->drain();
+
         decltype(_operationList) _swapList;
         {
             std::lock_guard<std::mutex> lck(_mtxOperation);
             _swapList.swap(_operationList);
         }
 
+        //退役后收到的任务转交接替的poller
+        auto next = successor();
+        if (next)
+        {
+            next->adopt(_swapList);
+            return;
+        }
+
         _swapList.for_each([&](const Operation::Ptr &operation) {
             try
             {
@@ -247,8 +542,358 @@ namespace JCToolKit
         });
     }
 
-    static std::mutex s_all_poller_mtx;
-    static std::map<std::thread::id, std::weak_ptr<EventPoller>> s_all_poller;
+    //每个poller线程只记录自己，查询当前poller时无需加锁查全局表
+    static thread_local std::weak_ptr<EventPoller> s_current_poller;
+
+    //当前线程运行的事件循环，投递任务时据此选择信箱
+    static thread_local EventPoller *s_current_loop = nullptr;
+
+    bool EventPoller::postMailbox(const Operation::Ptr &operation)
+    {
+        auto source = s_current_loop;
+        if (!source || source == this || !_pool || source->_pool != _pool || source->_poolIndex >= _mailboxCount)
+        {
+            return false;
+        }
+
+        //每个信箱只有来源poller线程写入，首次投递时创建无需加锁
+        auto &slot = _mailboxes[source->_poolIndex];
+        auto box = slot.load(std::memory_order_acquire);
+        if (!box)
+        {
+            box = new Mailbox(MAILBOX_SIZE);
+            slot.store(box, std::memory_order_release);
+        }
+
+        if (box->_overflowing.load(std::memory_order_acquire) || !box->_ring.push(operation))
+        {
+            std::lock_guard<std::mutex> lck(box->_mtx);
+            if (box->_overflowing.load(std::memory_order_relaxed) || !box->_ring.push(operation))
+            {
+                box->_overflowing.store(true, std::memory_order_relaxed);
+                box->_overflow.emplace_back(operation);
+            }
+        }
+
+        //从空变为非空时记录投递时间，先于_notified写入，避免准入检查读到上一批的时间
+        bool first = !box->_notified.load(std::memory_order_relaxed);
+        if (first)
+        {
+            box->_oldestMs.store(getCurrentMillisecond(), std::memory_order_relaxed);
+        }
+        if (!box->_notified.exchange(true))
+        {
+            if (!first)
+            {
+                box->_oldestMs.store(getCurrentMillisecond(), std::memory_order_relaxed);
+            }
+            _pipe.write("", 1);
+        }
+        return true;
+    }
+
+    size_t EventPoller::mailboxSize()
+    {
+        size_t ret = 0;
+        for (size_t i = 0; i < _mailboxCount; ++i)
+        {
+            auto box = _mailboxes[i].load(std::memory_order_acquire);
+            if (!box)
+            {
+                continue;
+            }
+            ret += box->_ring.size();
+            if (box->_overflowing.load(std::memory_order_acquire))
+            {
+                std::lock_guard<std::mutex> lck(box->_mtx);
+                ret += box->_overflow.size();
+            }
+        }
+        return ret;
+    }
+
+    uint64_t EventPoller::mailboxOldestMs()
+    {
+        uint64_t ret = UINT64_MAX;
+        for (size_t i = 0; i < _mailboxCount; ++i)
+        {
+            auto box = _mailboxes[i].load(std::memory_order_acquire);
+            if (!box || !box->_notified.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+            ret = std::min(ret, box->_oldestMs.load(std::memory_order_relaxed));
+        }
+        return ret;
+    }
+
+    void EventPoller::onMailbox()
+    {
+        auto next = successor();
+        decltype(_operationList) forward;
+        auto run = [&](const Operation::Ptr &operation) {
+            if (next)
+            {
+                forward.emplace_back(operation);
+                return;
+            }
+            try
+            {
+                (*operation)();
+            }
+            catch (ExitException &)
+            {
+                _exitFlag = true;
+            }
+            catch (std::exception &ex)
+            {
+                printf("EventPoller执行信箱任务捕获到异常: %s", ex.what());
+            }
+        };
+
+        Operation::Ptr operation;
+        for (size_t i = 0; i < _mailboxCount; ++i)
+        {
+            auto box = _mailboxes[i].load(std::memory_order_acquire);
+            //先读再交换，没有新任务的信箱不必独占其缓存行
+            if (!box || !box->_notified.load(std::memory_order_relaxed) || !box->_notified.exchange(false))
+            {
+                continue;
+            }
+            while (box->_ring.pop(operation))
+            {
+                run(operation);
+            }
+            if (!box->_overflowing.load(std::memory_order_acquire))
+            {
+                continue;
+            }
+
+            //溢出期间生产者不再写环形队列，队列中剩余的任务都早于溢出链表中的任务
+            while (box->_ring.pop(operation))
+            {
+                run(operation);
+            }
+            decltype(box->_overflow) overflow;
+            {
+                std::lock_guard<std::mutex> lck(box->_mtx);
+                overflow.swap(box->_overflow);
+                box->_overflowing.store(false, std::memory_order_release);
+            }
+            overflow.for_each(run);
+        }
+        operation = nullptr;
+        if (next)
+        {
+            next->adopt(forward);
+        }
+    }
+
+    void EventPoller::adopt(OperationList &list)
+    {
+        if (list.empty())
+        {
+            return;
+        }
+        auto next = successor();
+        if (next)
+        {
+            next->adopt(list);
+            return;
+        }
+        auto nowMs = getCurrentMillisecond();
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            markEnqueue(nowMs);
+            _operationList.append(list);
+        }
+        _pipe.write("", 1);
+    }
+
+    inline EventPoller *EventPoller::successor()
+    {
+        return _retired.load(std::memory_order_acquire) ? _successor.get() : nullptr;
+    }
+
+    void EventPoller::retire(const EventPoller::Ptr &target)
+    {
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            _successor = target;
+            _retired.store(true, std::memory_order_release);
+        }
+        s_current_poller.reset();
+
+        CancelToken::Scope scope(nullptr);
+        //定时任务保持原到期时间
+        auto timers = std::make_shared<decltype(_delayOperationMap)>();
+        timers->swap(_delayOperationMap);
+        if (!timers->empty())
+        {
+            auto poller = target.get();
+            target->asyncFirst([poller, timers]() {
+                poller->_delayOperationMap.insert(timers->begin(), timers->end());
+            }, false);
+        }
+
+        target->adopt(_yieldList);
+        //空闲任务仍作为空闲任务迁移；先从链表中摘下再转交，目标线程链入时本线程不再访问其链表节点
+        decltype(_idleList) idle;
+        idle.swap(_idleList);
+        while (!idle.empty())
+        {
+            auto operation = idle.front();
+            idle.pop_front();
+            target->onIdle_l(operation);
+        }
+        decltype(_operationList) pending;
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            pending.swap(_operationList);
+        }
+        target->adopt(pending);
+        onMailbox();
+
+        //宽限期内仍可能有其他线程按旧的状态投递，期间继续转交，之后退出事件循环
+        _delayOperationMap.emplace(getCurrentMillisecond() + RETIRE_GRACE_MS, std::make_shared<DelayOperation>([this]() -> uint64_t {
+            _exitFlag = true;
+            return 0;
+        }));
+    }
+
+    inline void EventPoller::onYield()
+    {
+        if (_yieldList.empty())
+        {
+            return;
+        }
+
+        //后续任务中再次让出的将排到下一轮事件循环
+        decltype(_yieldList) swapList;
+        swapList.swap(_yieldList);
+        _sliceStartUs = getCurrentMicrosecond();
+        swapList.for_each([&](const Operation::Ptr &operation) {
+            try
+            {
+                (*operation)();
+            }
+            catch (ExitException &)
+            {
+                _exitFlag = true;
+            }
+            catch (std::exception &ex)
+            {
+                printf("EventPoller执行让出的任务捕获到异常: %s", ex.what());
+            }
+        });
+    }
+
+    bool EventPoller::shouldYield()
+    {
+        return isCurrentThread() && getCurrentMicrosecond() - _sliceStartUs >= _yieldBudgetUs.load(std::memory_order_relaxed);
+    }
+
+    Operation::Ptr EventPoller::yield(OperationFunction continuation)
+    {
+        if (!isCurrentThread())
+        {
+            return async(std::move(continuation), false);
+        }
+        auto ret = Operation::create(std::move(continuation));
+        _yieldList.emplace_back(ret);
+        return ret;
+    }
+
+    void EventPoller::setYieldBudget(uint64_t budgetUs)
+    {
+        _yieldBudgetUs = budgetUs;
+    }
+
+    Operation::Ptr EventPoller::onIdle(OperationFunction operation)
+    {
+        auto ret = Operation::create(std::move(operation));
+        onIdle_l(ret);
+        return ret;
+    }
+
+    void EventPoller::onIdle_l(const Operation::Ptr &operation)
+    {
+        auto next = successor();
+        if (next)
+        {
+            next->onIdle_l(operation);
+            return;
+        }
+        if (isCurrentThread())
+        {
+            _idleList.emplace_back(operation);
+            return;
+        }
+        //任务本身已绑定当前CancelToken，转入本线程的操作不受其影响
+        CancelToken::Scope scope(nullptr);
+        async([this, operation]() {
+            onIdle_l(operation);
+        }, false);
+    }
+
+    void EventPoller::setIdlePolicy(uint64_t budgetUs, int maxLoad, uint64_t minSleepMs)
+    {
+        _idleBudgetUs = budgetUs;
+        _idleMaxLoad = maxLoad;
+        _idleMinSleepMs = minSleepMs;
+    }
+
+    bool EventPoller::checkIdle(uint64_t &minDelay)
+    {
+        if (_idleList.empty() || !_yieldList.empty())
+        {
+            return false;
+        }
+        auto minSleepMs = _idleMinSleepMs.load(std::memory_order_relaxed);
+        if (minDelay && minDelay < minSleepMs)
+        {
+            //定时任务即将到期，不值得插入空闲任务
+            return false;
+        }
+        if (load() > _idleMaxLoad.load(std::memory_order_relaxed))
+        {
+            auto recheck = minSleepMs ? minSleepMs : 1;
+            if (!minDelay || minDelay > recheck)
+            {
+                minDelay = recheck;
+            }
+            return false;
+        }
+        return true;
+    }
+
+    void EventPoller::runIdle()
+    {
+        auto budget = _idleBudgetUs.load(std::memory_order_relaxed);
+        auto start = getCurrentMicrosecond();
+        do
+        {
+            auto operation = _idleList.front();
+            _idleList.pop_front();
+            try
+            {
+                (*operation)();
+            }
+            catch (ExitException &)
+            {
+                _exitFlag = true;
+            }
+            catch (std::exception &ex)
+            {
+                printf("EventPoller执行空闲任务捕获到异常: %s \n", ex.what());
+            }
+        } while (!_idleList.empty() && getCurrentMicrosecond() - start < budget);
+    }
+
+    ReleaseStatistic EventPoller::getReleaseStatistic() const
+    {
+        return _releaseQueue->getStatistic();
+    }
 
     BufferRaw::Ptr EventPoller::getSharedBuffer()
     {
@@ -266,13 +911,7 @@ namespace JCToolKit
     //static
     EventPoller::Ptr EventPoller::getCurrentPoller()
     {
-        std::lock_guard<std::mutex> lck(s_all_poller_mtx);
-        auto it = s_all_poller.find(std::this_thread::get_id());
-        if (it == s_all_poller.end())
-        {
-            return nullptr;
-        }
-        return it->second.lock();
+        return s_current_poller.lock();
     }
 
     void EventPoller::runLoop(bool blocked, bool registSelf)
@@ -282,10 +921,11 @@ namespace JCToolKit
             ThreadPool::setPriority(_priority);
             std::lock_guard<std::mutex> lck(_mtxRunning);
             _loopThreadID = std::this_thread::get_id();
+            s_current_loop = this;
+            ReleaseQueue::current() = _releaseQueue;
             if (registSelf)
             {
-                std::lock_guard<std::mutex> lck(s_all_poller_mtx);
-                s_all_poller[_loopThreadID] = shared_from_this();
+                s_current_poller = shared_from_this();
             }
             _semWithRunStarted.post();
             _exitFlag = false;
@@ -293,24 +933,30 @@ namespace JCToolKit
 
 #if defined(HAS_EPOLL)
             struct epoll_event events[EPOLL_SIZE];
-            while (!_exitFlag)
-            {
-                minDelay = getMinDelay();
-                startSleep();
-                int ret = epoll_wait(_epollFd, events, EPOLL_SIZE, minDelay ? minDelay : -1);
-                wakeUp();
-                if (ret <= 0)
+            struct epoll_event highEvents[EPOLL_SIZE];
+            //events前部为上一轮超出上限留下的事件，边沿触发的fd不会再次上报，不能丢弃
+            int pending = 0;
+            //处理至多limit个fd的事件，内部管道不计入上限，超出的移到数组前部并返回其个数
+            auto dispatch = [&](int epollFd, struct epoll_event *list, int count, int limit) {
+                int dispatched = 0;
+                int left = 0;
+                for (int i = 0; i < count; ++i)
                 {
-                    continue;
-                }
-                for (int i = 0; i < ret; ++i)
-                {
-                    struct epoll_event &event = events[i];
+                    struct epoll_event &event = list[i];
                     int fd = event.data.fd;
+                    if (fd == _epollFdHigh)
+                    {
+                        continue;
+                    }
+                    if (fd != _pipe.readFD() && dispatched++ >= limit)
+                    {
+                        list[left++] = event;
+                        continue;
+                    }
                     auto it = _eventMap.find(fd);
                     if (it == _eventMap.end())
                     {
-                        epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+                        epoll_ctl(epollFd, EPOLL_CTL_DEL, fd, NULL);
                         continue;
                     }
                     auto callBack = it->second;
@@ -323,6 +969,52 @@ namespace JCToolKit
                         printf("EventPoller执行事件回调捕获到异常: %s \n", ex.what());
                     }
                 }
+                return left;
+            };
+            //本轮再次就绪的fd合并到上一轮留下的事件中，其余追加在后
+            auto merge = [&](int count) {
+                int total = pending;
+                for (int i = pending; i < count; ++i)
+                {
+                    int j = 0;
+                    while (j < pending && events[j].data.fd != events[i].data.fd)
+                    {
+                        ++j;
+                    }
+                    if (j < pending)
+                    {
+                        events[j].events |= events[i].events;
+                        continue;
+                    }
+                    events[total++] = events[i];
+                }
+                return total;
+            };
+            while (!_exitFlag)
+            {
+                minDelay = getMinDelay();
+                //有空闲任务时先不休眠，没有就绪的事件才执行空闲任务
+                bool idle = checkIdle(minDelay);
+                startSleep();
+                //有让出的后续任务或留下的事件时不休眠，只收取已就绪的事件
+                int ret = epoll_wait(_epollFd, events + pending, EPOLL_SIZE - pending, (pending || !_yieldList.empty() || idle) ? 0 : (minDelay ? minDelay : -1));
+                wakeUp();
+                _sliceStartUs = getCurrentMicrosecond();
+                onMailbox();
+                _releaseQueue->drain();
+                //高优先级事件以0超时收取，先于普通事件处理
+                if (_highEventCount)
+                {
+                    dispatch(_epollFdHigh, highEvents, epoll_wait(_epollFdHigh, highEvents, getIOClassLimit(IO_CLASS_HIGH), 0), EPOLL_SIZE);
+                }
+                //普通事件的上限只计算普通fd，不含内部管道与高优先级epoll
+                int count = ret > 0 ? merge(pending + ret) : pending;
+                pending = dispatch(_epollFd, events, count, getIOClassLimit(IO_CLASS_BULK));
+                onYield();
+                if (idle && count == 0)
+                {
+                    runIdle();
+                }
             }
 #else
             int ret, maxFd;
@@ -332,6 +1024,8 @@ namespace JCToolKit
 
             while (!_exitFlag)
             {
+                minDelay = getMinDelay();
+                bool idle = checkIdle(minDelay);
                 tv.tv_sec = (decltype(tv.tv_sec))(minDelay / 1000);
                 tv.tv_usec = 1000 * (minDelay % 1000);
 
@@ -360,15 +1054,30 @@ namespace JCToolKit
                     }
                 }
 
+                if (!_yieldList.empty() || idle)
+                {
+                    tv.tv_sec = 0;
+                    tv.tv_usec = 0;
+                }
+
                 startSleep();
-                ret = jc_select(maxFd + 1, &set_read, &set_write, &set_err, minDelay ? &tv : NULL);
+                ret = jc_select(maxFd + 1, &set_read, &set_write, &set_err, (minDelay || !_yieldList.empty() || idle) ? &tv : NULL);
                 wakeUp();
+                _sliceStartUs = getCurrentMicrosecond();
+                onMailbox();
+                _releaseQueue->drain();
 
                 if (ret <= 0)
                 {
+                    onYield();
+                    if (idle && ret == 0)
+                    {
+                        runIdle();
+                    }
                     continue;
                 }
 
+                int eventCount[IO_CLASS_MAX] = {0};
                 for (auto &record : _eventMap)
                 {
                     int event = 0;
@@ -384,10 +1093,20 @@ namespace JCToolKit
                     {
                         event |= PollEventError;
                     }
-                    if (event != 0)
+                    //超出本轮上限的事件留到下一轮，高优先级事件排在前面先处理
+                    auto ioClass = record.second->ioClass;
+                    if (event != 0 && eventCount[ioClass] < getIOClassLimit(ioClass))
                     {
+                        ++eventCount[ioClass];
                         record.second->attach = event;
-                        callbackList.emplace_back(record.second);
+                        if (ioClass == IO_CLASS_HIGH)
+                        {
+                            callbackList.emplace_front(record.second);
+                        }
+                        else
+                        {
+                            callbackList.emplace_back(record.second);
+                        }
                     }
                 }
 
@@ -402,8 +1121,20 @@ namespace JCToolKit
                     }
                 });
                 callbackList.clear();
+                onYield();
             }
 #endif
+            //线程退出后转回的对象由释放线程直接释放
+            ReleaseQueue::current() = nullptr;
+            _releaseQueue->close();
+            _releaseQueue->drain();
+            if (_retired)
+            {
+                //线程号可能被之后创建的线程复用
+                _loopThreadID = std::thread::id();
+                s_current_loop = nullptr;
+                _retireDone = true;
+            }
         }
         else
         {
@@ -460,8 +1191,13 @@ namespace JCToolKit
         return flushDelayOperation(now);
     }
 
-    DelayOperation::Ptr EventPoller::startDelayOperation(uint64_t delayMs, std::function<uint64_t()> op)
+    DelayOperation::Ptr EventPoller::startDelayOperation(uint64_t delayMs, DelayOperation::FunctionType op)
     {
+        auto next = successor();
+        if (next)
+        {
+            return next->startDelayOperation(delayMs, std::move(op));
+        }
         DelayOperation::Ptr ret = std::make_shared<DelayOperation>(std::move(op));
         auto timeLine = getCurrentMillisecond() + delayMs;
         asyncFirst([timeLine, ret, this]() {
@@ -471,24 +1207,100 @@ namespace JCToolKit
         return ret;
     }
 
+    DelayOperation::Ptr EventPoller::asyncCoalesce(const std::string &key, OperationFunction op, uint64_t debounceMs, CoalesceMode mode)
+    {
+        auto table = _coalesceTable;
+        std::lock_guard<std::mutex> lck(table->_mtx);
+        auto deadline = getCurrentMillisecond() + debounceMs;
+        CoalesceTable::Slot::Ptr slot;
+        if (table->coalesce(key, op, mode, slot, true))
+        {
+            //每次提交都推迟执行时间，定时器到期时再补足剩余时间
+            slot->_deadlineMs = deadline;
+            return slot->_delayOperation;
+        }
+        slot->_deadlineMs = deadline;
+        //槽位持有定时任务，定时任务只能弱引用槽位，否则形成循环引用
+        std::weak_ptr<CoalesceTable::Slot> weakSlot = slot;
+        slot->_delayOperation = startDelayOperation(debounceMs, [table, key, weakSlot]() -> uint64_t {
+            OperationFunction op;
+            {
+                std::lock_guard<std::mutex> lck(table->_mtx);
+                auto slot = weakSlot.lock();
+                if (!slot)
+                {
+                    return 0;
+                }
+                auto now = getCurrentMillisecond();
+                if (slot->_deadlineMs > now)
+                {
+                    return slot->_deadlineMs - now;
+                }
+                op = table->take(key, slot, true);
+            }
+            if (op)
+            {
+                op();
+            }
+            return 0;
+        });
+        return slot->_delayOperation;
+    }
+
     // MARK: EventPollerPool
     size_t s_pool_size = 0;
+    static CpuPlacement s_placement = CPU_PLACEMENT_NONE;
+    static std::vector<int> s_cpu_set;
+    static bool s_shared_nothing = false;
+    //为0时不开启动态伸缩
+    static size_t s_min_size = 0;
+    static int s_scale_up_load = 80;
+    static int s_scale_down_load = 20;
+    static uint64_t s_scale_interval_ms = 1000;
 
     INSTANCE_IMP(EventPollerPool);
 
     EventPoller::Ptr EventPollerPool::getFirstPoller()
     {
-        return std::dynamic_pointer_cast<EventPoller>(_executors.front());
+        return _firstPoller;
     }
 
     EventPoller::Ptr EventPollerPool::getPoller()
     {
         auto poller = EventPoller::getCurrentPoller();
-        if (_preferCurrentThread && poller)
+        if ((_preferCurrentThread || s_shared_nothing) && poller)
         {
             return poller;
         }
-        return std::dynamic_pointer_cast<EventPoller>(getExecutor());
+        auto demand = ++_demand;
+        auto ret = std::dynamic_pointer_cast<EventPoller>(getExecutor());
+        if (getExecutorSize() >= _maxSize || !needPoller(ret, demand))
+        {
+            return ret;
+        }
+        std::lock_guard<std::mutex> lck(_mtxResize);
+        //加锁后重新选取并检查，避免并发调用者在同一时刻各自新建
+        ret = std::dynamic_pointer_cast<EventPoller>(getExecutor());
+        if (getExecutorSize() < _maxSize && needPoller(ret, demand))
+        {
+            auto added = addPoller();
+            if (added)
+            {
+                return added;
+            }
+        }
+        return ret;
+    }
+
+    bool EventPollerPool::needPoller(const EventPoller::Ptr &leastLoaded, size_t demand)
+    {
+        if (!s_min_size)
+        {
+            //固定大小时每个poller都被获取过后才新建下一个
+            return demand > getExecutorSize();
+        }
+        //动态伸缩时负载最低的poller也已繁忙才新建
+        return leastLoaded->load() >= s_scale_up_load;
     }
 
     void EventPollerPool::preferCurrentThread(bool flag)
@@ -496,17 +1308,169 @@ namespace JCToolKit
         _preferCurrentThread = flag;
     }
 
+    size_t EventPollerPool::resize(size_t size)
+    {
+        size = std::max<size_t>(1, std::min(size, _maxSize));
+        std::lock_guard<std::mutex> lck(_mtxResize);
+        releaseRetired();
+        while (getExecutorSize() < size && addPoller())
+        {
+        }
+        while (getExecutorSize() > size && removePoller())
+        {
+        }
+        return getExecutorSize();
+    }
+
+    EventPoller::Ptr EventPollerPool::addPoller()
+    {
+        if (getExecutorSize() >= _maxSize)
+        {
+            return nullptr;
+        }
+        size_t index = _nextIndex;
+        if (_freeIndex.empty())
+        {
+            ++_nextIndex;
+        }
+        else
+        {
+            index = _freeIndex.back();
+            _freeIndex.pop_back();
+        }
+
+        EventPoller::Ptr ret(new EventPoller);
+        //信箱需在事件循环启动前就绪，退役中的poller仍占用序号，超出上限的序号不使用信箱
+        ret->_pool = this;
+        ret->_poolIndex = index;
+        ret->_mailboxCount = _maxSize;
+        ret->_mailboxes.reset(new std::atomic<EventPoller::Mailbox *>[_maxSize]);
+        for (size_t i = 0; i < _maxSize; ++i)
+        {
+            ret->_mailboxes[i] = nullptr;
+        }
+        ret->runLoop(false, true);
+        if (s_placement != CPU_PLACEMENT_NONE)
+        {
+            ret->setAffinity(CpuTopology::Instance().placement(s_placement, index, s_cpu_set));
+        }
+        addExecutor(ret);
+        return ret;
+    }
+
+    bool EventPollerPool::removePoller()
+    {
+        auto executors = getExecutors();
+        EventPoller::Ptr victim;
+        int victimLoad = 0;
+        for (auto &executor : *executors)
+        {
+            auto load = executor->load();
+            if (executor != _firstPoller && (!victim || load < victimLoad))
+            {
+                victim = std::dynamic_pointer_cast<EventPoller>(executor);
+                victimLoad = load;
+            }
+        }
+        if (!victim)
+        {
+            return false;
+        }
+
+        EventPoller::Ptr target;
+        int targetLoad = 0;
+        for (auto &executor : *executors)
+        {
+            auto load = executor->load();
+            if (executor != victim && (!target || load < targetLoad))
+            {
+                target = std::dynamic_pointer_cast<EventPoller>(executor);
+                targetLoad = load;
+            }
+        }
+
+        //先移出池，之后getPoller不再返回该poller
+        removeExecutor(victim);
+        _retiring.emplace_back(victim);
+        CancelToken::Scope scope(nullptr);
+        victim->async([this, victim, target]() {
+            if (victim->_eventMap.size() > 1)
+            {
+                //注册了fd的poller无法迁移，放回池中
+                std::lock_guard<std::mutex> lck(_mtxResize);
+                _retiring.erase(std::find(_retiring.begin(), _retiring.end(), victim));
+                addExecutor(victim);
+                return;
+            }
+            victim->retire(target);
+        }, false);
+        return true;
+    }
+
+    void EventPollerPool::releaseRetired()
+    {
+        for (auto it = _retiring.begin(); it != _retiring.end();)
+        {
+            if ((*it)->_retireDone && it->use_count() == 1)
+            {
+                _freeIndex.emplace_back((*it)->_poolIndex);
+                it = _retiring.erase(it);
+                continue;
+            }
+            ++it;
+        }
+    }
+
+    void EventPollerPool::checkScaling()
+    {
+        std::lock_guard<std::mutex> lck(_mtxResize);
+        releaseRetired();
+        auto loads = getExecutorLoad();
+        int total = 0;
+        for (auto load : loads)
+        {
+            total += load;
+        }
+        auto avg = loads.empty() ? 0 : total / (int)loads.size();
+        if (avg >= s_scale_up_load)
+        {
+            addPoller();
+        }
+        else if (avg < s_scale_down_load && loads.size() > s_min_size)
+        {
+            removePoller();
+        }
+    }
+
     EventPollerPool::EventPollerPool()
     {
-        auto size = s_pool_size > 0 ? s_pool_size : std::thread::hardware_concurrency();
+        _maxSize = s_pool_size > 0 ? s_pool_size : std::thread::hardware_concurrency();
+        if (s_pool_size == 0 && s_placement == CPU_PLACEMENT_PHYSICAL_CORE)
+        {
+            //每个物理核一个EventPoller
+            _maxSize = CpuTopology::Instance().physicalCoreCount();
+        }
+        if (_maxSize == 0)
+        {
+            _maxSize = 1;
+        }
 
-        createExecutors([]() {
-            EventPoller::Ptr ret(new EventPoller);
-            ret->runLoop(false, true);
-            return ret;
-        }, size);
+        //其余poller在需要时才创建
+        {
+            std::lock_guard<std::mutex> lck(_mtxResize);
+            _firstPoller = addPoller();
+        }
 
-        printf("创建EventPoller个数: %ld \n", size);
+        if (s_min_size)
+        {
+            CancelToken::Scope scope(nullptr);
+            _firstPoller->startDelayOperation(s_scale_interval_ms, [this]() -> uint64_t {
+                checkScaling();
+                return s_scale_interval_ms;
+            });
+        }
+
+        printf("EventPoller个数上限: %ld \n", _maxSize);
     }
 
     void EventPollerPool::setPoolSize(size_t size)
@@ -514,4 +1478,29 @@ namespace JCToolKit
         s_pool_size = size;
     }
 
-}
+    void EventPollerPool::setPlacement(CpuPlacement placement, const std::vector<int> &cpuSet)
+    {
+        s_placement = placement;
+        s_cpu_set = cpuSet;
+    }
+
+    void EventPollerPool::setSharedNothing(bool enable)
+    {
+        s_shared_nothing = enable;
+        SocketHandler::setDNSCachePerThread(enable);
+    }
+
+    bool EventPollerPool::isSharedNothing()
+    {
+        return s_shared_nothing;
+    }
+
+    void EventPollerPool::setDynamic(size_t minSize, int scaleUpLoad, int scaleDownLoad, uint64_t intervalMs)
+    {
+        s_min_size = minSize ? minSize : 1;
+        s_scale_up_load = scaleUpLoad;
+        s_scale_down_load = scaleDownLoad;
+        s_scale_interval_ms = intervalMs ? intervalMs : 1000;
+    }
+
+}
\ No newline at end of file
@@ -7,6 +7,8 @@
 #include "Thread/OperationExecutor.h"
 #include "Thread/Semaphore.h"
 #include "Network/Buffer.h"
+#include "Util/RingBuffer.h"
+#include "Util/DeferredRelease.h"
 #include "Pipe.h"
 
 #if defined(__linux__) || defined(__linux)
@@ -23,21 +25,73 @@ namespace JCToolKit
         PollEventLT = 1 << 3,    //水平触发
     } PollEvent;
 
-    typedef std::function<void(int event)> PollEventCallBack;
-    typedef std::function<void(bool success)> PollDeleteCallBack;
+    typedef unique_function<void(int event)> PollEventCallBack;
+    typedef unique_function<void(bool success)> PollDeleteCallBack;
     typedef OperationCancelableImp<uint64_t(void)> DelayOperation;
 
+#if defined(ENABLE_COROUTINE)
+    class SleepAwaiter;
+#endif
+
     class EventPoller : public OperationExecutor, public std::enable_shared_from_this<EventPoller>
     {
     public:
         typedef std::shared_ptr<EventPoller> Ptr;
         friend class EventPollerPool;
+
+        //准入优先级，过载时低优先级任务先被拒绝
+        typedef enum
+        {
+            ADMIT_LOW = 0,    //队列达到限制的一半即拒绝
+            ADMIT_NORMAL = 1, //队列达到限制时拒绝
+            ADMIT_HIGH = 2,   //不受限制，始终入队
+        } AdmitPriority;
+
+        typedef enum
+        {
+            ADMIT_OK = 0,           //已执行或已入队
+            ADMIT_REJECT_DEPTH = 1, //任务队列过长
+            ADMIT_REJECT_AGE = 2,   //队首任务等待过久
+        } AdmitResult;
+
+        //准入统计
+        class AdmissionStatistic
+        {
+        public:
+            uint64_t _admitted = 0;  //准入的任务数
+            uint64_t _shedDepth = 0; //因队列过长被拒绝的任务数
+            uint64_t _shedAge = 0;   //因等待过久被拒绝的任务数
+            uint64_t _shedLow = 0;   //其中低优先级任务数
+
+            //拒绝率
+            double shedRate() const
+            {
+                auto shed = _shedDepth + _shedAge;
+                return shed + _admitted ? (double)shed / (shed + _admitted) : 0;
+            }
+        };
+        //I/O优先级，每轮事件循环中高优先级fd的事件先于普通fd处理
+        typedef enum
+        {
+            IO_CLASS_BULK = 0, //普通数据连接
+            IO_CLASS_HIGH = 1, //控制信令等对延时敏感的连接
+            IO_CLASS_MAX,
+        } IOClass;
+
         friend class WorkThreadPool;
         ~EventPoller();
 
         static EventPoller &Instance();
 
-        int addEvent(int fd, int event, PollEventCallBack callBack);
+        /**
+         * 添加事件监听
+         * @param fd 文件描述符
+         * @param event PollEvent组合
+         * @param callBack 事件回调
+         * @param ioClass I/O优先级，高优先级fd注册在独立的epoll中，每轮先于普通fd收取与处理
+         * @return -1失败，0成功
+         */
+        int addEvent(int fd, int event, PollEventCallBack callBack, IOClass ioClass = IO_CLASS_BULK);
 
         int deleteEvent(int fd, PollDeleteCallBack callBack = nullptr);
 
@@ -47,14 +101,103 @@ namespace JCToolKit
 
         Operation::Ptr asyncFirst(OperationFunction operation, bool maySync = true) override;
 
+        using OperationExecutorProtocol::asyncBatch;
+
+        std::vector<Operation::Ptr> asyncBatch(std::vector<OperationFunction> operations, bool maySync = true, bool contiguous = false) override;
+
+        /**
+         * 带准入控制的异步执行，队列超过限制时直接拒绝，便于上游快速失败而不是排队超时
+         * @param operation 任务
+         * @param priority 准入优先级
+         * @param result 准入结果，返回nullptr时可据此区分是同步执行了还是被拒绝了
+         * @param maySync 是否允许在本线程同步执行
+         * @return 入队的任务，同步执行或被拒绝时返回nullptr
+         */
+        Operation::Ptr asyncAdmit(OperationFunction operation, AdmitPriority priority = ADMIT_NORMAL, AdmitResult *result = nullptr, bool maySync = true);
+
+        /**
+         * 设置任务队列的准入限制，只对asyncAdmit生效，async/asyncFirst及内部任务不受影响
+         * 同池poller线程经信箱投递的任务同样计入深度与等待时间
+         * @param maxDepth 队列中最多排队的任务数，0表示不限制
+         * @param maxAgeMs 最早排队的任务最长等待时间(毫秒)，0表示不限制
+         */
+        void setAdmissionLimit(size_t maxDepth, uint64_t maxAgeMs = 0);
+
+        AdmissionStatistic getAdmissionStatistic() const;
+
+        /**
+         * 设置每轮事件循环中某一I/O优先级最多处理的事件数，超出的事件留到下一轮
+         * @param ioClass I/O优先级
+         * @param maxEvents 最多处理的事件数，0表示不限制
+         */
+        void setIOClassLimit(IOClass ioClass, size_t maxEvents);
+
+        using OperationExecutorProtocol::asyncCoalesce;
+
+        /**
+         * 带防抖的合并提交，同key任务在最后一次提交后debounceMs毫秒内无新提交才执行
+         * 与不带防抖的asyncCoalesce分别合并，同名key的两种提交互不影响
+         * @param key 任务标识
+         * @param operation 任务
+         * @param debounceMs 防抖时间(毫秒)
+         * @param mode 已有同key任务在等待时，替换其任务函数或丢弃本次提交
+         * @return 等待中的定时任务，可用于取消
+         */
+        DelayOperation::Ptr asyncCoalesce(const std::string &key, OperationFunction operation, uint64_t debounceMs, CoalesceMode mode = COALESCE_REPLACE);
+
+        /**
+         * 长任务用于判断是否应让出事件循环，本轮循环已执行超过时间预算时返回true
+         * 非本EventPoller线程调用时始终返回false
+         */
+        bool shouldYield();
+
+        /**
+         * 让出事件循环，continuation排在已就绪的网络事件之后执行，并获得新的时间预算
+         * 非本EventPoller线程调用时等同于async
+         * @param continuation 后续任务
+         * @return 后续任务，可用于取消
+         */
+        Operation::Ptr yield(OperationFunction continuation);
+
+        //设置每轮事件循环的时间预算(微秒)，默认5毫秒
+        void setYieldBudget(uint64_t budgetUs);
+
+        /**
+         * 提交空闲任务，只在事件循环本将休眠时执行：没有就绪的事件与待执行任务，
+         * 且最近的定时任务不会很快到期；负载超过阈值时推迟，适合整理缓存、汇总统计等后台工作
+         * 每个任务只执行一次，需要周期执行时在任务中再次提交
+         * @param operation 任务
+         * @return 空闲任务，可用于取消
+         */
+        Operation::Ptr onIdle(OperationFunction operation);
+
+        /**
+         * 设置空闲任务的执行策略
+         * @param budgetUs 每轮事件循环中执行空闲任务的时间预算(微秒)，至少执行一个
+         * @param maxLoad 负载(0~100)超过该值时推迟执行
+         * @param minSleepMs 最近的定时任务在该时间(毫秒)内到期时不执行
+         */
+        void setIdlePolicy(uint64_t budgetUs, int maxLoad = 50, uint64_t minSleepMs = 10);
+
         bool isCurrentThread();
 
-        DelayOperation::Ptr startDelayOperation(uint64_t delayMs, std::function<uint64_t()> op);
+        //将事件循环线程绑定到cpus中的CPU上，cpus为空时解除绑定
+        void setAffinity(const std::vector<int> &cpus);
+
+        DelayOperation::Ptr startDelayOperation(uint64_t delayMs, DelayOperation::FunctionType op);
+
+#if defined(ENABLE_COROUTINE)
+        //协程中co_await poller->sleep(ms)，在本poller线程中恢复，定义见Coroutine.h
+        SleepAwaiter sleep(uint64_t delayMs);
+#endif
 
         static EventPoller::Ptr getCurrentPoller();
 
         BufferRaw::Ptr getSharedBuffer();
 
+        //在本线程创建、在其他线程最后释放的对象转回本线程批量释放的统计
+        ReleaseStatistic getReleaseStatistic() const;
+
     private:
         EventPoller(ThreadPool::Priority priority = ThreadPool::PRIORITY_HIGHEST);
 
@@ -62,6 +205,51 @@ namespace JCToolKit
 
         void onPipeEvent();
 
+        //同一EventPollerPool中的poller线程向本poller投递任务时走点对点信箱，返回false表示不适用
+        bool postMailbox(const Operation::Ptr &operation);
+
+        //在每轮事件循环开始时批量执行各信箱中的任务
+        void onMailbox();
+
+        //各信箱中排队的任务数，近似值
+        size_t mailboxSize();
+
+        //各信箱中最早任务的投递时间(毫秒)，近似值，为UINT64_MAX表示信箱都已取空
+        uint64_t mailboxOldestMs();
+
+        //执行让出的后续任务
+        void onYield();
+
+        /**
+         * 判断本轮是否执行空闲任务，需在休眠前调用
+         * 因负载过高推迟时缩短minDelay，使休眠期间负载回落后能重新检查
+         */
+        bool checkIdle(uint64_t &minDelay);
+
+        //在时间预算内执行空闲任务
+        void runIdle();
+
+        //加入空闲任务列表，非本线程时转入本线程，已退役时转交接替的poller
+        void onIdle_l(const Operation::Ptr &operation);
+
+        //接收其他poller转交的任务
+        void adopt(OperationList &list);
+
+        //已退役时返回接替的poller
+        EventPoller *successor();
+
+        /**
+         * 退役，需在本线程调用：定时任务与待执行任务迁移到target，此后投递给本poller的任务、
+         * 定时任务与事件注册都转交target，宽限期过后事件循环退出
+         */
+        void retire(const EventPoller::Ptr &target);
+
+        //需在_mtxOperation锁内调用，pending为信箱中排队的任务数
+        AdmitResult checkAdmission(AdmitPriority priority, uint64_t nowMs, size_t pending, uint64_t pendingSinceMs);
+
+        //需在_mtxOperation锁内、入队前调用，记录队首任务的入队时间
+        void markEnqueue(uint64_t nowMs);
+
         Operation::Ptr async_l(OperationFunction operation, bool maySync = true, bool first = false);
 
         void wait();
@@ -72,6 +260,9 @@ namespace JCToolKit
 
         uint64_t getMinDelay();
 
+        //每轮最多收取的事件数，不超过事件数组大小
+        int getIOClassLimit(IOClass ioClass);
+
     private:
         class ExitException : public std::exception
         {
@@ -94,10 +285,23 @@ namespace JCToolKit
         PipeWrapper _pipe;
 
         std::mutex _mtxOperation;
-        List<Operation::Ptr> _operationList;
+        OperationList _operationList;
+        //_operationList中最早任务的入队时间，毫秒
+        uint64_t _oldestEnqueueMs = 0;
+
+        std::atomic<size_t> _maxDepth{0};
+        std::atomic<uint64_t> _maxAgeMs{0};
+        std::atomic<uint64_t> _admittedCount{0};
+        std::atomic<uint64_t> _shedDepthCount{0};
+        std::atomic<uint64_t> _shedAgeCount{0};
+        std::atomic<uint64_t> _shedLowCount{0};
 
 #if defined(HAS_EPOLL)
         int _epollFd = -1;
+        //高优先级fd所在的epoll，自身以读事件注册在_epollFd中，有事件时唤醒事件循环
+        int _epollFdHigh = -1;
+        //注册在_epollFdHigh中的fd个数，只在本线程访问，为0时不必收取高优先级事件
+        size_t _highEventCount = 0;
         std::unordered_map<int, std::shared_ptr<PollEventCallBack>> _eventMap;
 #else
         struct PollRecord
@@ -105,13 +309,70 @@ namespace JCToolKit
             typedef std::shared_ptr<PollRecord> Ptr;
             int event;
             int attach;
+            IOClass ioClass;
             PollEventCallBack callBack;
         };
         std::unordered_map<int, PollRecord::Ptr> _eventMap;
 #endif
+        std::atomic<size_t> _ioClassLimit[IO_CLASS_MAX];
         std::multimap<uint64_t, DelayOperation::Ptr> _delayOperationMap;
+
+        //本线程创建的对象在其他线程释放时转回的队列
+        ReleaseQueue *_releaseQueue = nullptr;
+
+        /**
+         * 点对点信箱，每个来源poller独占一个，单生产者单消费者无锁传递任务
+         * 环形队列满时转入加锁的溢出链表，溢出期间的任务都进入溢出链表以保持顺序
+         * 信箱先于_operationList执行，同池poller线程的async/asyncBatch/asyncAdmit都走信箱以保持同一来源的顺序；
+         * asyncFirst有意插队，仍进入_operationList队首
+         */
+        class Mailbox
+        {
+        public:
+            Mailbox(size_t capacity) : _ring(capacity) {}
+
+            SpscRingBuffer<Operation::Ptr> _ring;
+            //自上次取出后是否已唤醒过，保证从空变为非空时只写一次管道
+            std::atomic<bool> _notified{false};
+            //自上次取出后首个任务的投递时间，毫秒，_notified为true时有效
+            std::atomic<uint64_t> _oldestMs{0};
+            std::atomic<bool> _overflowing{false};
+            std::mutex _mtx;
+            OperationList _overflow;
+        };
+
+        //所属EventPollerPool及在其中的序号，不属于任何池时信箱不生效
+        const void *_pool = nullptr;
+        size_t _poolIndex = 0;
+        //按来源poller序号索引，由来源poller首次投递时创建
+        std::unique_ptr<std::atomic<Mailbox *>[]> _mailboxes;
+        size_t _mailboxCount = 0;
+
+        //退役后接替的poller，在_mtxOperation锁内于_retired置位前设置
+        EventPoller::Ptr _successor;
+        std::atomic<bool> _retired{false};
+        //退役后事件循环已退出
+        std::atomic<bool> _retireDone{false};
+
+        //让出事件循环的后续任务，只在本线程访问
+        OperationList _yieldList;
+        //本轮事件循环开始的时间，微秒
+        uint64_t _sliceStartUs = 0;
+        std::atomic<uint64_t> _yieldBudgetUs{5000};
+
+        //空闲任务，只在本线程访问
+        OperationList _idleList;
+        std::atomic<uint64_t> _idleBudgetUs{1000};
+        std::atomic<int> _idleMaxLoad{50};
+        std::atomic<uint64_t> _idleMinSleepMs{10};
     };
 
+    /**
+     * EventPoller池，poller在首次需要时才创建，数量不超过上限
+     * 未开启动态伸缩时已有poller都被getPoller获取过后才新建下一个，直到上限，相当于按需逐个启动固定大小的池；
+     * 开启动态伸缩后getPoller只在所有poller负载都超过扩容阈值时新建，并按平均负载定期扩容或缩容，
+     * 缩容时选取负载最低且没有注册fd的poller，将其定时任务与待执行任务迁移到其他poller后退出
+     */
     class EventPollerPool : public std::enable_shared_from_this<EventPollerPool>, public OperationExecutorProvider
     {
     public:
@@ -120,19 +381,79 @@ namespace JCToolKit
 
         static EventPollerPool &Instance();
 
+        //设置poller个数上限，0为CPU核数，需在首次调用Instance之前设置
         static void setPoolSize(size_t size = 0);
 
+        //设置EventPoller绑核策略，需在首次调用Instance之前设置
+        static void setPlacement(CpuPlacement placement, const std::vector<int> &cpuSet = std::vector<int>());
+
+        /**
+         * 设置无共享模式，需在首次调用Instance之前设置，通常与setPlacement搭配实现每核一个EventPoller
+         * 开启后dns缓存按线程隔离，在poller线程中getPoller始终返回当前poller，
+         * 不同poller之间只通过显式的async传递消息
+         */
+        static void setSharedNothing(bool enable = true);
+
+        static bool isSharedNothing();
+
+        /**
+         * 开启动态伸缩，需在首次调用Instance之前设置
+         * @param minSize 缩容时至少保留的poller个数
+         * @param scaleUpLoad 平均负载(0~100)达到该值时扩容，getPoller按需新建时也使用该阈值
+         * @param scaleDownLoad 平均负载低于该值时缩容
+         * @param intervalMs 检查间隔(毫秒)
+         */
+        static void setDynamic(size_t minSize = 1, int scaleUpLoad = 80, int scaleDownLoad = 20, uint64_t intervalMs = 1000);
+
         EventPoller::Ptr getPoller();
 
+        //第一个poller，创建后不会被缩容
         EventPoller::Ptr getFirstPoller();
 
+        //无共享模式下始终优先当前线程，此设置无效
         void preferCurrentThread(bool isPrefer = true);
 
+        /**
+         * 调整poller个数，缩容是异步的，有注册fd的poller不会被缩容
+         * @param size 目标个数，限制在1与上限之间
+         * @return 调整后的个数
+         */
+        size_t resize(size_t size);
+
+        size_t getMaxSize() const
+        {
+            return _maxSize;
+        }
+
     private:
         EventPollerPool();
 
+        //新建一个poller，已达上限时返回nullptr，需在_mtxResize锁内调用
+        EventPoller::Ptr addPoller();
+
+        //选取一个poller退役，没有可退役的poller时返回false，需在_mtxResize锁内调用
+        bool removePoller();
+
+        //释放事件循环已退出且无人引用的退役poller，需在_mtxResize锁内调用
+        void releaseRetired();
+
+        void checkScaling();
+
+        //getPoller是否需要新建poller，leastLoaded为负载最低的poller，demand为累计获取次数
+        bool needPoller(const EventPoller::Ptr &leastLoaded, size_t demand);
+
     private:
         bool _preferCurrentThread = true;
+        //getPoller累计调用次数，未开启动态伸缩时据此按需新建
+        std::atomic<size_t> _demand{0};
+        size_t _maxSize;
+
+        std::mutex _mtxResize;
+        EventPoller::Ptr _firstPoller;
+        //已分配的最大序号与退役后可复用的序号
+        size_t _nextIndex = 0;
+        std::vector<size_t> _freeIndex;
+        std::vector<EventPoller::Ptr> _retiring;
     };
 
 }
\ No newline at end of file
@@ -0,0 +1,525 @@
+#include "Fiber.h"
+#include "Util/uv_errno.h"
+
+#include <poll.h>
+#include <errno.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <thread>
+#include <vector>
+#include <stdexcept>
+
+#if (defined(__x86_64__) || defined(__aarch64__)) && defined(__ELF__)
+#define FIBER_ASM_CONTEXT
+#else
+#include <ucontext.h>
+#endif
+
+#define FIBER_DEFAULT_STACK_SIZE (128 * 1024)
+#define FIBER_STACK_CACHE_SIZE 64
+
+namespace JCToolKit
+{
+    void fiberMain(Fiber *fiber);
+}
+
+#if defined(FIBER_ASM_CONTEXT)
+
+//保存被调用者保存寄存器到当前栈，并将栈指针写入*fromSp，然后切换到toSp上的上下文
+extern "C" void jc_fiber_switch(void **fromSp, void *toSp);
+//新纤程首次被切换进入时的返回地址，纤程指针存放在被调用者保存寄存器中
+extern "C" void jc_fiber_entry();
+
+extern "C" __attribute__((visibility("hidden"), used)) void jc_fiber_main(JCToolKit::Fiber *fiber)
+{
+    JCToolKit::fiberMain(fiber);
+}
+
+#if defined(__x86_64__)
+asm(R"(
+    .text
+    .globl jc_fiber_switch
+    .hidden jc_fiber_switch
+    .type jc_fiber_switch,@function
+    .p2align 4
+jc_fiber_switch:
+    pushq %rbp
+    pushq %rbx
+    pushq %r12
+    pushq %r13
+    pushq %r14
+    pushq %r15
+    subq $8, %rsp
+    stmxcsr (%rsp)
+    fnstcw 4(%rsp)
+    movq %rsp, (%rdi)
+    movq %rsi, %rsp
+    ldmxcsr (%rsp)
+    fldcw 4(%rsp)
+    addq $8, %rsp
+    popq %r15
+    popq %r14
+    popq %r13
+    popq %r12
+    popq %rbx
+    popq %rbp
+    ret
+    .size jc_fiber_switch,.-jc_fiber_switch
+
+    .globl jc_fiber_entry
+    .hidden jc_fiber_entry
+    .type jc_fiber_entry,@function
+    .p2align 4
+jc_fiber_entry:
+    movq %r12, %rdi
+    call jc_fiber_main
+    ud2
+    .size jc_fiber_entry,.-jc_fiber_entry
+)");
+#else
+asm(R"(
+    .text
+    .globl jc_fiber_switch
+    .hidden jc_fiber_switch
+    .type jc_fiber_switch,%function
+    .p2align 4
+jc_fiber_switch:
+    sub sp, sp, #176
+    stp d8, d9, [sp, #0]
+    stp d10, d11, [sp, #16]
+    stp d12, d13, [sp, #32]
+    stp d14, d15, [sp, #48]
+    stp x19, x20, [sp, #64]
+    stp x21, x22, [sp, #80]
+    stp x23, x24, [sp, #96]
+    stp x25, x26, [sp, #112]
+    stp x27, x28, [sp, #128]
+    stp x29, x30, [sp, #144]
+    mov x2, sp
+    str x2, [x0]
+    mov sp, x1
+    ldp d8, d9, [sp, #0]
+    ldp d10, d11, [sp, #16]
+    ldp d12, d13, [sp, #32]
+    ldp d14, d15, [sp, #48]
+    ldp x19, x20, [sp, #64]
+    ldp x21, x22, [sp, #80]
+    ldp x23, x24, [sp, #96]
+    ldp x25, x26, [sp, #112]
+    ldp x27, x28, [sp, #128]
+    ldp x29, x30, [sp, #144]
+    add sp, sp, #176
+    ret
+    .size jc_fiber_switch,.-jc_fiber_switch
+
+    .globl jc_fiber_entry
+    .hidden jc_fiber_entry
+    .type jc_fiber_entry,%function
+    .p2align 4
+jc_fiber_entry:
+    mov x0, x19
+    bl jc_fiber_main
+    brk #0
+    .size jc_fiber_entry,.-jc_fiber_entry
+)");
+#endif
+
+#endif //FIBER_ASM_CONTEXT
+
+namespace JCToolKit
+{
+    static size_t pageSize()
+    {
+        static size_t s_page_size = sysconf(_SC_PAGESIZE);
+        return s_page_size;
+    }
+
+    //线程本地的纤程栈缓存，按大小精确匹配复用
+    class FiberStackCache
+    {
+    public:
+        ~FiberStackCache()
+        {
+            for (auto &stack : _stacks)
+            {
+                munmap(stack.first, stack.second + pageSize());
+            }
+        }
+
+        //返回映射区起始地址，最低的一页为保护页
+        static void *allocate(size_t size)
+        {
+            auto &stacks = local()._stacks;
+            for (auto it = stacks.begin(); it != stacks.end(); ++it)
+            {
+                if (it->second == size)
+                {
+                    auto ret = it->first;
+                    stacks.erase(it);
+                    return ret;
+                }
+            }
+
+            auto ret = mmap(nullptr, size + pageSize(), PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (ret == MAP_FAILED)
+            {
+                throw std::runtime_error(StrPrinter() << "分配纤程栈失败:" << get_uv_errmsg(true));
+            }
+            //栈向低地址增长，溢出时访问保护页触发SIGSEGV而不是踩坏其他内存
+            if (mprotect(ret, pageSize(), PROT_NONE) == -1)
+            {
+                munmap(ret, size + pageSize());
+                throw std::runtime_error(StrPrinter() << "设置纤程栈保护页失败:" << get_uv_errmsg(true));
+            }
+            return ret;
+        }
+
+        static void deallocate(void *stack, size_t size)
+        {
+            auto &stacks = local()._stacks;
+            if (stacks.size() >= FIBER_STACK_CACHE_SIZE)
+            {
+                munmap(stack, size + pageSize());
+                return;
+            }
+            stacks.emplace_back(stack, size);
+        }
+
+    private:
+        static FiberStackCache &local()
+        {
+            static thread_local FiberStackCache s_cache;
+            return s_cache;
+        }
+
+    private:
+        std::vector<std::pair<void *, size_t>> _stacks;
+    };
+
+    static thread_local Fiber *s_current_fiber = nullptr;
+
+#if defined(FIBER_ASM_CONTEXT)
+    //在栈顶构造一个jc_fiber_switch保存的现场，首次切换进入时返回到jc_fiber_entry
+    static void *makeContext(void *stackTop, Fiber *fiber)
+    {
+        auto top = reinterpret_cast<uintptr_t>(stackTop) & ~(uintptr_t)15;
+#if defined(__x86_64__)
+        auto sp = reinterpret_cast<uint64_t *>(top - 64);
+        sp[0] = 0x1F80 | ((uint64_t)0x037F << 32); // mxcsr与x87控制字的默认值
+        sp[1] = 0;                                  // r15
+        sp[2] = 0;                                  // r14
+        sp[3] = 0;                                  // r13
+        sp[4] = reinterpret_cast<uint64_t>(fiber);  // r12
+        sp[5] = 0;                                  // rbx
+        sp[6] = 0;                                  // rbp
+        sp[7] = reinterpret_cast<uint64_t>(&jc_fiber_entry);
+#else
+        auto sp = reinterpret_cast<uint64_t *>(top - 176);
+        memset(sp, 0, 176);
+        sp[8] = reinterpret_cast<uint64_t>(fiber);            // x19
+        sp[19] = reinterpret_cast<uint64_t>(&jc_fiber_entry); // x30
+#endif
+        return sp;
+    }
+
+    static inline void switchContext(void **from, void *to)
+    {
+        jc_fiber_switch(from, to);
+    }
+#else
+    static void fiberTrampoline(unsigned int high, unsigned int low)
+    {
+        fiberMain(reinterpret_cast<Fiber *>(((uintptr_t)high << 32) | low));
+    }
+
+    static void *makeContext(void *stack, size_t size, Fiber *fiber)
+    {
+        auto context = new ucontext_t;
+        getcontext(context);
+        context->uc_stack.ss_sp = stack;
+        context->uc_stack.ss_size = size;
+        context->uc_link = nullptr;
+        auto ptr = reinterpret_cast<uintptr_t>(fiber);
+        makecontext(context, (void (*)())fiberTrampoline, 2, (unsigned int)(ptr >> 32), (unsigned int)ptr);
+        return context;
+    }
+
+    static inline void switchContext(void **from, void *to)
+    {
+        if (!*from)
+        {
+            *from = new ucontext_t;
+        }
+        swapcontext(static_cast<ucontext_t *>(*from), static_cast<ucontext_t *>(to));
+    }
+
+    static inline void freeContext(void *context)
+    {
+        delete static_cast<ucontext_t *>(context);
+    }
+#endif
+
+    void fiberMain(Fiber *fiber)
+    {
+        Fiber::run(fiber);
+    }
+
+    Fiber::Fiber(const EventPoller::Ptr &poller, Entry entry, size_t stackSize) : _poller(poller), _entry(std::move(entry))
+    {
+        auto page = pageSize();
+        _stackSize = ((stackSize ? stackSize : FIBER_DEFAULT_STACK_SIZE) + page - 1) / page * page;
+        _stack = FiberStackCache::allocate(_stackSize);
+        auto stackBottom = static_cast<char *>(_stack) + page;
+#if defined(FIBER_ASM_CONTEXT)
+        _context = makeContext(stackBottom + _stackSize, this);
+#else
+        _context = makeContext(stackBottom, _stackSize, this);
+#endif
+    }
+
+    Fiber::~Fiber()
+    {
+#if !defined(FIBER_ASM_CONTEXT)
+        freeContext(_context);
+        freeContext(_callerContext);
+#endif
+        if (_stack)
+        {
+            FiberStackCache::deallocate(_stack, _stackSize);
+        }
+    }
+
+    Fiber::Ptr Fiber::start(const EventPoller::Ptr &poller, Entry entry, size_t stackSize)
+    {
+        Ptr ret(new Fiber(poller, std::move(entry), stackSize));
+        ret->_self = ret;
+        //启动任务属于纤程本身，不随CancelToken取消；总是异步启动，避免在其他纤程中嵌套执行
+        CancelToken::Scope scope(nullptr);
+        poller->async([ret]() {
+            ret->resume();
+        }, false);
+        return ret;
+    }
+
+    void Fiber::run(Fiber *fiber)
+    {
+        try
+        {
+            fiber->_entry();
+        }
+        catch (std::exception &ex)
+        {
+            printf("纤程执行捕获到异常: %s \n", ex.what());
+        }
+        catch (...)
+        {
+            //异常不能越过纤程入口，否则将展开到没有调用帧信息的汇编代码中
+            printf("纤程执行捕获到未知异常\n");
+        }
+        fiber->_entry = nullptr;
+        fiber->_finished = true;
+        fiber->park();
+    }
+
+    Fiber *Fiber::current()
+    {
+        return s_current_fiber;
+    }
+
+    void Fiber::park()
+    {
+        //令牌在resume中切换，切回后调度者恢复自己的令牌，纤程的令牌保存在_token中
+        switchContext(&_context, _callerContext);
+    }
+
+    void Fiber::resume()
+    {
+        if (_finished)
+        {
+            return;
+        }
+        auto last = s_current_fiber;
+        s_current_fiber = this;
+        //切入时换上纤程自身的令牌，调度者的令牌暂存在_token中，切回后换回
+        CancelToken::current().swap(_token);
+        switchContext(&_callerContext, _context);
+        CancelToken::current().swap(_token);
+        s_current_fiber = last;
+
+        if (_finished)
+        {
+            //栈在本线程缓存，释放自身引用后this可能已被销毁
+            FiberStackCache::deallocate(_stack, _stackSize);
+            _stack = nullptr;
+            auto self = std::move(_self);
+        }
+    }
+
+    void Fiber::suspend()
+    {
+        auto fiber = current();
+        if (!fiber)
+        {
+            throw std::runtime_error("Fiber::suspend只能在纤程中调用");
+        }
+        fiber->park();
+    }
+
+    void Fiber::yield()
+    {
+        auto fiber = current();
+        if (!fiber)
+        {
+            std::this_thread::yield();
+            return;
+        }
+        auto self = fiber->_self;
+        fiber->_poller->yield([self]() {
+            self->resume();
+        });
+        fiber->park();
+    }
+
+    void Fiber::sleep(uint64_t delayMs)
+    {
+        auto fiber = current();
+        if (!fiber)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(delayMs));
+            return;
+        }
+        auto self = fiber->_self;
+        {
+            //恢复纤程的定时任务不随纤程当前的令牌取消，作用域不能跨越park
+            CancelToken::Scope scope(nullptr);
+            fiber->_poller->startDelayOperation(delayMs, [self]() -> uint64_t {
+                self->resume();
+                return 0;
+            });
+        }
+        fiber->park();
+    }
+
+    int Fiber::wait(int fd, int event, uint64_t timeoutMs)
+    {
+        auto fiber = current();
+        if (!fiber)
+        {
+            struct pollfd pfd = {};
+            pfd.fd = fd;
+            pfd.events = ((event & PollEventRead) ? POLLIN : 0) | ((event & PollEventWrite) ? POLLOUT : 0);
+            if (poll(&pfd, 1, timeoutMs ? (int)timeoutMs : -1) <= 0)
+            {
+                return 0;
+            }
+            return ((pfd.revents & POLLIN) ? PollEventRead : 0) | ((pfd.revents & POLLOUT) ? PollEventWrite : 0) |
+                   ((pfd.revents & (POLLERR | POLLHUP)) ? PollEventError : 0);
+        }
+
+        //以下局部变量在纤程恢复前一直有效，回调直接通过指针写入
+        int trigger = 0;
+        DelayOperation::Ptr timer;
+        auto triggerPtr = &trigger;
+        auto timerPtr = &timer;
+        auto self = fiber->_self;
+        auto poller = fiber->_poller;
+        {
+            //恢复纤程的回调不随纤程当前的令牌取消，作用域只覆盖注册，不能跨越park
+            CancelToken::Scope scope(nullptr);
+            //水平触发，注册前已就绪的事件不会丢失
+            if (poller->addEvent(fd, event | PollEventError | PollEventLT, [poller, fd, self, triggerPtr, timerPtr](int ev) {
+                    poller->deleteEvent(fd);
+                    if (*timerPtr)
+                    {
+                        (*timerPtr)->cancel();
+                    }
+                    *triggerPtr = ev;
+                    self->resume();
+                }) == -1)
+            {
+                return PollEventError;
+            }
+
+            if (timeoutMs)
+            {
+                timer = poller->startDelayOperation(timeoutMs, [poller, fd, self]() -> uint64_t {
+                    //移除fd监听，其回调不会再被触发
+                    poller->deleteEvent(fd);
+                    self->resume();
+                    return 0;
+                });
+            }
+        }
+        fiber->park();
+        return trigger;
+    }
+
+    ssize_t Fiber::read(int fd, void *buf, size_t len)
+    {
+        while (true)
+        {
+            auto ret = ::read(fd, buf, len);
+            if (ret >= 0 || !current())
+            {
+                return ret;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                return ret;
+            }
+            wait(fd, PollEventRead);
+        }
+    }
+
+    ssize_t Fiber::write(int fd, const void *buf, size_t len)
+    {
+        while (true)
+        {
+            auto ret = ::write(fd, buf, len);
+            if (ret >= 0 || !current())
+            {
+                return ret;
+            }
+            if (errno == EINTR)
+            {
+                continue;
+            }
+            if (errno != EAGAIN && errno != EWOULDBLOCK)
+            {
+                return ret;
+            }
+            wait(fd, PollEventWrite);
+        }
+    }
+
+    int Fiber::connect(int fd, const struct sockaddr *addr, socklen_t len, uint64_t timeoutMs)
+    {
+        auto ret = ::connect(fd, addr, len);
+        if (ret == 0 || errno != EINPROGRESS || !current())
+        {
+            return ret;
+        }
+        if (wait(fd, PollEventWrite, timeoutMs) == 0)
+        {
+            errno = ETIMEDOUT;
+            return -1;
+        }
+        int error = 0;
+        socklen_t errorLen = sizeof(error);
+        if (getsockopt(fd, SOL_SOCKET, SO_ERROR, &error, &errorLen) == -1)
+        {
+            return -1;
+        }
+        if (error)
+        {
+            errno = error;
+            return -1;
+        }
+        return 0;
+    }
+}
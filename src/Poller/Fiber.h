@@ -0,0 +1,114 @@
+#pragma once
+
+#include <memory>
+#include <sys/socket.h>
+#include "EventPoller.h"
+#include "Thread/CancelToken.h"
+#include "Util/Utilities.h"
+#include "Util/UniqueFunction.h"
+
+namespace JCToolKit
+{
+    /**
+     * 运行在EventPoller线程上的有栈纤程，可以用同步的写法编写网络代码
+     * 纤程中调用Fiber::read/write/connect/sleep时，通过addEvent或延时任务挂起当前纤程并让出poller线程，
+     * 事件触发后在同一个poller线程中恢复；x86-64与aarch64下上下文切换为手写汇编，其他平台使用ucontext
+     * 栈通过mmap分配，栈底有一页保护页，用完后在本线程缓存复用
+     */
+    class Fiber : public noncopyable
+    {
+    public:
+        typedef std::shared_ptr<Fiber> Ptr;
+        typedef unique_function<void()> Entry;
+
+        ~Fiber();
+
+        /**
+         * 创建纤程并在poller线程中开始执行
+         * @param poller 纤程所在的EventPoller，纤程只会在该poller线程中运行
+         * @param entry 纤程入口，抛出的异常被捕获并打印
+         * @param stackSize 栈大小，0为默认的128KB
+         */
+        static Ptr start(const EventPoller::Ptr &poller, Entry entry, size_t stackSize = 0);
+
+        //当前线程正在执行的纤程，不在纤程中时返回nullptr
+        static Fiber *current();
+
+        /**
+         * 挂起当前纤程，直到有人调用其resume
+         * 用于在纤程中等待其他异步结果
+         */
+        static void suspend();
+
+        //恢复被挂起的纤程，只能在其poller线程中、纤程之外调用
+        void resume();
+
+        //让出poller线程，排在已就绪的网络事件之后继续执行
+        static void yield();
+
+        /**
+         * 休眠，在纤程中挂起当前纤程，不在纤程中时阻塞当前线程
+         * @param delayMs 休眠毫秒数
+         */
+        static void sleep(uint64_t delayMs);
+
+        /**
+         * 在纤程中等待fd可读写
+         * @param fd 文件描述符，不能已通过addEvent注册到同一个poller
+         * @param event PollEventRead或PollEventWrite
+         * @param timeoutMs 超时毫秒数，0为不超时
+         * @return 触发的PollEvent，超时返回0
+         */
+        static int wait(int fd, int event, uint64_t timeoutMs = 0);
+
+        /**
+         * 与系统调用用法一致，数据未就绪时挂起当前纤程而不是阻塞poller线程
+         * fd需为非阻塞模式(SocketHandler::setNoBlocked)，不在纤程中调用时等同于系统调用
+         */
+        static ssize_t read(int fd, void *buf, size_t len);
+
+        static ssize_t write(int fd, const void *buf, size_t len);
+
+        /**
+         * 非阻塞connect并在纤程中等待连接结果
+         * @param timeoutMs 超时毫秒数，0为不超时，超时时errno为ETIMEDOUT
+         * @return 0成功，-1失败
+         */
+        static int connect(int fd, const struct sockaddr *addr, socklen_t len, uint64_t timeoutMs = 0);
+
+        bool finished() const
+        {
+            return _finished;
+        }
+
+        const EventPoller::Ptr &getPoller() const
+        {
+            return _poller;
+        }
+
+    private:
+        Fiber(const EventPoller::Ptr &poller, Entry entry, size_t stackSize);
+
+        //纤程切回调度者
+        void park();
+
+        static void run(Fiber *fiber);
+
+        friend void fiberMain(Fiber *fiber);
+
+    private:
+        EventPoller::Ptr _poller;
+        Entry _entry;
+        bool _finished = false;
+        //运行期间持有自身，执行完毕后释放
+        Ptr _self;
+        //纤程挂起期间保存其CancelToken::current()，运行期间保存调度者的
+        CancelToken::Ptr _token;
+
+        void *_stack = nullptr;
+        size_t _stackSize;
+        //纤程与调度者各自的上下文
+        void *_context = nullptr;
+        void *_callerContext = nullptr;
+    };
+}
@@ -0,0 +1,422 @@
+#include "MultiThreadPoller.h"
+
+#if defined(HAS_EPOLL)
+
+#include "Network/SocketHandler.h"
+#include "Util/Utilities.h"
+#include "Util/uv_errno.h"
+
+#include <unistd.h>
+#include <sys/epoll.h>
+#include <sys/timerfd.h>
+
+#define EPOLL_SIZE 1024
+//每次只取一个事件，其余就绪事件留给其他空闲线程，按事件而不是按连接均衡负载
+#define EVENTS_PER_WAIT 1
+#define toEpoll(event) (((event)&PollEventRead) ? EPOLLIN : 0) | (((event)&PollEventWrite) ? EPOLLOUT : 0) | (((event)&PollEventError) ? (EPOLLHUP | EPOLLERR) : 0) | (((event)&PollEventLT) ? 0 : EPOLLET)
+#define toPoller(epoll_event) (((epoll_event)&EPOLLIN) ? PollEventRead : 0) | (((epoll_event)&EPOLLOUT) ? PollEventWrite : 0) | (((epoll_event)&EPOLLHUP) ? PollEventError : 0) | (((epoll_event)&EPOLLERR) ? PollEventError : 0)
+
+namespace JCToolKit
+{
+    //当前线程所属的轮询器
+    static thread_local MultiThreadPoller *s_current_multi_poller = nullptr;
+
+    MultiThreadPoller::Ptr MultiThreadPoller::create(size_t threadNum, ThreadPool::Priority priority)
+    {
+        Ptr ret(new MultiThreadPoller(priority));
+        ret->start(threadNum ? threadNum : std::thread::hardware_concurrency());
+        return ret;
+    }
+
+    MultiThreadPoller::MultiThreadPoller(ThreadPool::Priority priority)
+    {
+        _priority = priority;
+        SocketHandler::setNoBlocked(_pipe.readFD());
+        SocketHandler::setNoBlocked(_pipe.writeFD());
+
+        _epollFd = epoll_create(EPOLL_SIZE);
+        if (_epollFd == -1)
+        {
+            throw std::runtime_error(StrPrinter() << "创建epoll失败" << get_uv_errmsg(true));
+        }
+        SocketHandler::setCloExec(_epollFd);
+
+        _timerFd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+        if (_timerFd == -1)
+        {
+            close(_epollFd);
+            throw std::runtime_error(StrPrinter() << "创建timerfd失败" << get_uv_errmsg(true));
+        }
+
+        //管道与timerfd同样以ONESHOT注册，同一时刻只有一个线程处理任务队列或定时任务的到期
+        struct epoll_event epollEvent{};
+        epollEvent.events = (toEpoll(PollEventRead | PollEventLT)) | EPOLLONESHOT;
+        epollEvent.data.fd = _pipe.readFD();
+        if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _pipe.readFD(), &epollEvent) == -1)
+        {
+            close(_timerFd);
+            close(_epollFd);
+            throw std::runtime_error("epoll添加管道失败");
+        }
+        epollEvent.data.fd = _timerFd;
+        if (epoll_ctl(_epollFd, EPOLL_CTL_ADD, _timerFd, &epollEvent) == -1)
+        {
+            close(_timerFd);
+            close(_epollFd);
+            throw std::runtime_error("epoll添加timerfd失败");
+        }
+    }
+
+    MultiThreadPoller::~MultiThreadPoller()
+    {
+        //每个线程收到退出通知后不读管道即重新注册，退出前再写一次管道，唤醒下一个线程，直到全部退出
+        _exitFlag = true;
+        _pipe.write("", 1);
+        for (auto &thread : _threads)
+        {
+            try
+            {
+                thread.join();
+            }
+            catch (const std::exception &e)
+            {
+                std::cerr << e.what() << '\n';
+            }
+        }
+
+        close(_timerFd);
+        close(_epollFd);
+
+        //执行剩余的异步任务
+        decltype(_operationList) swapList;
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            swapList.swap(_operationList);
+        }
+        swapList.for_each([&](const Operation::Ptr &operation) {
+            try
+            {
+                (*operation)();
+            }
+            catch (std::exception &ex)
+            {
+                printf("MultiThreadPoller执行异步任务捕获到异常: %s \n", ex.what());
+            }
+        });
+    }
+
+    void MultiThreadPoller::start(size_t threadNum)
+    {
+        for (size_t i = 0; i < threadNum; ++i)
+        {
+            _threads.emplace_back(&MultiThreadPoller::runLoop, this);
+        }
+    }
+
+    int MultiThreadPoller::addEvent(int fd, int event, PollEventCallBack callBack)
+    {
+        if (!callBack)
+        {
+            return -1;
+        }
+
+        EventRecord::Ptr record = std::make_shared<EventRecord>();
+        record->_event = event;
+        record->_callBack = std::move(callBack);
+
+        struct epoll_event epollEvent{};
+        epollEvent.events = (toEpoll(event)) | EPOLLONESHOT;
+        epollEvent.data.fd = fd;
+
+        //先放入表中再注册，避免事件在记录可见前就被其他线程取走
+        std::lock_guard<std::mutex> lck(_mtxEvent);
+        if (!_eventMap.emplace(fd, record).second)
+        {
+            return -1;
+        }
+        int ret = epoll_ctl(_epollFd, EPOLL_CTL_ADD, fd, &epollEvent);
+        if (ret != 0)
+        {
+            _eventMap.erase(fd);
+        }
+        return ret;
+    }
+
+    int MultiThreadPoller::deleteEvent(int fd, PollDeleteCallBack callBack)
+    {
+        bool success;
+        {
+            std::lock_guard<std::mutex> lck(_mtxEvent);
+            success = epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL) == 0 && _eventMap.erase(fd) > 0;
+        }
+        if (callBack)
+        {
+            callBack(success);
+        }
+        return success ? 0 : -1;
+    }
+
+    int MultiThreadPoller::modifyEvent(int fd, int event)
+    {
+        std::lock_guard<std::mutex> lck(_mtxEvent);
+        auto it = _eventMap.find(fd);
+        if (it == _eventMap.end())
+        {
+            return -1;
+        }
+        it->second->_event = event;
+        if (it->second->_running)
+        {
+            //回调结束后按新的事件重新注册
+            return 0;
+        }
+        struct epoll_event epollEvent{};
+        epollEvent.events = (toEpoll(event)) | EPOLLONESHOT;
+        epollEvent.data.fd = fd;
+        return epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &epollEvent);
+    }
+
+    Operation::Ptr MultiThreadPoller::async(OperationFunction op, bool maySync)
+    {
+        return async_l(std::move(op), maySync, false);
+    }
+
+    Operation::Ptr MultiThreadPoller::asyncFirst(OperationFunction op, bool maySync)
+    {
+        return async_l(std::move(op), maySync, true);
+    }
+
+    Operation::Ptr MultiThreadPoller::async_l(OperationFunction op, bool maySync, bool first)
+    {
+        if (maySync && isCurrentThread())
+        {
+            op();
+            return nullptr;
+        }
+
+        auto ret = Operation::create(std::move(op));
+        bool notify;
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            //处理线程先读管道再取队列，队列非空时已有唤醒在途，不必重复写管道
+            notify = _operationList.empty();
+            if (first)
+            {
+                _operationList.emplace_front(ret);
+            }
+            else
+            {
+                _operationList.emplace_back(ret);
+            }
+        }
+
+        if (notify)
+        {
+            _pipe.write("", 1);
+        }
+        return ret;
+    }
+
+    DelayOperation::Ptr MultiThreadPoller::startDelayOperation(uint64_t delayMs, DelayOperation::FunctionType op)
+    {
+        DelayOperation::Ptr ret = std::make_shared<DelayOperation>(std::move(op));
+        auto timeLine = getCurrentMillisecond() + delayMs;
+        std::lock_guard<std::mutex> lck(_mtxDelay);
+        auto it = _delayOperationMap.emplace(timeLine, ret);
+        if (it == _delayOperationMap.begin())
+        {
+            //成为最早到期的任务时提前timerfd
+            resetTimer();
+        }
+        return ret;
+    }
+
+    bool MultiThreadPoller::isCurrentThread()
+    {
+        return s_current_multi_poller == this;
+    }
+
+    void MultiThreadPoller::runLoop()
+    {
+        ThreadPool::setPriority(_priority);
+        s_current_multi_poller = this;
+
+        struct epoll_event events[EVENTS_PER_WAIT];
+        while (!_exitFlag)
+        {
+            startSleep();
+            int ret = epoll_wait(_epollFd, events, EVENTS_PER_WAIT, -1);
+            wakeUp();
+            for (int i = 0; i < ret; ++i)
+            {
+                struct epoll_event &event = events[i];
+                int fd = event.data.fd;
+                if (fd == _pipe.readFD())
+                {
+                    onPipeEvent();
+                }
+                else if (fd == _timerFd)
+                {
+                    onTimerEvent();
+                }
+                else
+                {
+                    onFdEvent(fd, event.events);
+                }
+            }
+        }
+        //退出通知可能已被本线程读走，保证管道可读，其他线程才能被唤醒并退出
+        _pipe.write("", 1);
+        s_current_multi_poller = nullptr;
+    }
+
+    void MultiThreadPoller::onPipeEvent()
+    {
+        if (_exitFlag)
+        {
+            //不读走管道中的数据，重新注册后由下一个线程收到退出通知
+            rearm(_pipe.readFD(), PollEventRead | PollEventLT);
+            return;
+        }
+
+        char buffer[1024];
+        int error = 0;
+        do
+        {
+            if (_pipe.read(buffer, sizeof(buffer)) > 0)
+            {
+                continue;
+            }
+            error = get_uv_error(true);
+        } while (error != UV_EAGAIN);
+
+        if (_exitFlag)
+        {
+            //检查退出标志后、读管道前开始析构时，退出通知已被上面读走，写回后再重新注册
+            _pipe.write("", 1);
+        }
+
+        decltype(_operationList) swapList;
+        {
+            std::lock_guard<std::mutex> lck(_mtxOperation);
+            swapList.swap(_operationList);
+        }
+        //取走任务后即重新注册，之后投递的任务可由其他线程并行执行
+        rearm(_pipe.readFD(), PollEventRead | PollEventLT);
+
+        swapList.for_each([&](const Operation::Ptr &operation) {
+            try
+            {
+                (*operation)();
+            }
+            catch (std::exception &ex)
+            {
+                printf("MultiThreadPoller执行异步任务捕获到异常: %s \n", ex.what());
+            }
+        });
+    }
+
+    void MultiThreadPoller::onTimerEvent()
+    {
+        //读走到期次数，timerfd可能已被重设而读不到，按当前时间取到期任务即可
+        uint64_t expirations;
+        ssize_t size = read(_timerFd, &expirations, sizeof(expirations));
+        (void)size;
+
+        auto now = getCurrentMillisecond();
+        decltype(_delayOperationMap) dueMap;
+        {
+            std::lock_guard<std::mutex> lck(_mtxDelay);
+            auto end = _delayOperationMap.upper_bound(now);
+            dueMap.insert(_delayOperationMap.begin(), end);
+            _delayOperationMap.erase(_delayOperationMap.begin(), end);
+            resetTimer();
+        }
+        //取走到期任务后即重新注册，后续到期的任务可由其他线程并行执行
+        rearm(_timerFd, PollEventRead | PollEventLT);
+
+        for (auto &pr : dueMap)
+        {
+            try
+            {
+                auto nextDelayTime = (*(pr.second))();
+                if (nextDelayTime)
+                {
+                    std::lock_guard<std::mutex> lck(_mtxDelay);
+                    auto it = _delayOperationMap.emplace(nextDelayTime + now, std::move(pr.second));
+                    if (it == _delayOperationMap.begin())
+                    {
+                        resetTimer();
+                    }
+                }
+            }
+            catch (std::exception &ex)
+            {
+                printf("MultiThreadPoller执行延时任务捕获到异常: %s \n", ex.what());
+            }
+        }
+    }
+
+    void MultiThreadPoller::onFdEvent(int fd, uint32_t events)
+    {
+        EventRecord::Ptr record;
+        {
+            std::lock_guard<std::mutex> lck(_mtxEvent);
+            auto it = _eventMap.find(fd);
+            if (it == _eventMap.end())
+            {
+                epoll_ctl(_epollFd, EPOLL_CTL_DEL, fd, NULL);
+                return;
+            }
+            record = it->second;
+            record->_running = true;
+        }
+
+        try
+        {
+            record->_callBack(toPoller(events));
+        }
+        catch (std::exception &ex)
+        {
+            printf("MultiThreadPoller执行事件回调捕获到异常: %s \n", ex.what());
+        }
+
+        std::lock_guard<std::mutex> lck(_mtxEvent);
+        record->_running = false;
+        auto it = _eventMap.find(fd);
+        //回调中已删除或被重新添加的fd不再由本记录重新注册
+        if (it != _eventMap.end() && it->second == record)
+        {
+            rearm(fd, record->_event);
+        }
+    }
+
+    void MultiThreadPoller::rearm(int fd, int event)
+    {
+        struct epoll_event epollEvent{};
+        epollEvent.events = (toEpoll(event)) | EPOLLONESHOT;
+        epollEvent.data.fd = fd;
+        epoll_ctl(_epollFd, EPOLL_CTL_MOD, fd, &epollEvent);
+    }
+
+    void MultiThreadPoller::resetTimer()
+    {
+        struct itimerspec spec = {{0, 0}, {0, 0}};
+        auto it = _delayOperationMap.begin();
+        if (it != _delayOperationMap.end())
+        {
+            auto now = getCurrentMillisecond();
+            auto delay = it->first > now ? it->first - now : 0;
+            spec.it_value.tv_sec = (decltype(spec.it_value.tv_sec))(delay / 1000);
+            spec.it_value.tv_nsec = (decltype(spec.it_value.tv_nsec))((delay % 1000) * 1000000);
+            if (!delay)
+            {
+                //it_value全为0表示停止定时器，已到期的任务需立即触发
+                spec.it_value.tv_nsec = 1;
+            }
+        }
+        timerfd_settime(_timerFd, 0, &spec, NULL);
+    }
+}
+
+#endif //HAS_EPOLL
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <unordered_map>
+#include "EventPoller.h"
+
+#if defined(HAS_EPOLL)
+
+namespace JCToolKit
+{
+    /**
+     * 多线程共享一个epoll的事件轮询器，适用于连接少但每条消息计算量大的场景
+     * 所有fd以EPOLLONESHOT注册，事件由任意一个空闲线程取走，回调执行完毕后才重新注册，
+     * 因此同一个fd的回调不会并发执行，而不同fd的回调按事件在各线程间自动均衡
+     * 定时任务由timerfd驱动，异步任务队列由管道唤醒，同样由任意一个线程执行；
+     * 与EventPoller不同，同一个执行器投递的任务、定时任务可能在不同线程中并发执行
+     */
+    class MultiThreadPoller : public OperationExecutor
+    {
+    public:
+        typedef std::shared_ptr<MultiThreadPoller> Ptr;
+
+        /**
+         * @param threadNum 线程个数，0为CPU核数
+         * @param priority 线程优先级
+         */
+        static Ptr create(size_t threadNum = 0, ThreadPool::Priority priority = ThreadPool::PRIORITY_HIGHEST);
+
+        ~MultiThreadPoller();
+
+        /**
+         * 添加事件监听
+         * @param fd 文件描述符
+         * @param event PollEvent组合
+         * @param callBack 事件回调，在任意一个线程中执行，同一个fd不会并发回调
+         * @return -1失败，0成功
+         */
+        int addEvent(int fd, int event, PollEventCallBack callBack);
+
+        //删除事件监听，正在执行的回调不受影响，执行完毕后不再重新注册
+        int deleteEvent(int fd, PollDeleteCallBack callBack = nullptr);
+
+        //修改监听的事件，回调执行期间修改的在回调结束后生效
+        int modifyEvent(int fd, int event);
+
+        Operation::Ptr async(OperationFunction operation, bool maySync = true) override;
+
+        Operation::Ptr asyncFirst(OperationFunction operation, bool maySync = true) override;
+
+        //在任意一个线程中执行，返回值为下次执行的间隔毫秒数，为0时不再执行
+        DelayOperation::Ptr startDelayOperation(uint64_t delayMs, DelayOperation::FunctionType op);
+
+        //当前线程是否为本轮询器的线程之一
+        bool isCurrentThread();
+
+        size_t getThreadNum() const
+        {
+            return _threads.size();
+        }
+
+    private:
+        MultiThreadPoller(ThreadPool::Priority priority);
+
+        void start(size_t threadNum);
+
+        void runLoop();
+
+        void onPipeEvent();
+
+        void onTimerEvent();
+
+        void onFdEvent(int fd, uint32_t events);
+
+        //重新注册ONESHOT事件
+        void rearm(int fd, int event);
+
+        //设置timerfd在最早的定时任务到期时触发，需在_mtxDelay锁内调用
+        void resetTimer();
+
+        Operation::Ptr async_l(OperationFunction operation, bool maySync, bool first);
+
+    private:
+        class EventRecord
+        {
+        public:
+            typedef std::shared_ptr<EventRecord> Ptr;
+
+            int _event;
+            //回调执行期间不重新注册，结束后按最新的_event重新注册
+            bool _running = false;
+            PollEventCallBack _callBack;
+        };
+
+        ThreadPool::Priority _priority;
+        std::atomic<bool> _exitFlag{false};
+        std::vector<std::thread> _threads;
+
+        int _epollFd = -1;
+        int _timerFd = -1;
+        PipeWrapper _pipe;
+
+        std::mutex _mtxEvent;
+        std::unordered_map<int, EventRecord::Ptr> _eventMap;
+
+        std::mutex _mtxOperation;
+        OperationList _operationList;
+
+        std::mutex _mtxDelay;
+        std::multimap<uint64_t, DelayOperation::Ptr> _delayOperationMap;
+    };
+}
+
+#endif // HAS_EPOLL
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include "Util/Utilities.h"
+
+namespace JCToolKit
+{
+    /**
+     * 可分层的取消令牌，取消父令牌等同于取消其所有子令牌，取消操作为O(1)
+     * 在CancelToken::Scope作用域内创建的Operation与DelayOperation会绑定当前令牌，
+     * 令牌取消后这些任务在出队或到期时直接跳过；任务执行期间其令牌自动成为当前令牌，
+     * 因此任务中再投递的任务也属于同一令牌
+     */
+    class CancelToken : public noncopyable
+    {
+    public:
+        typedef std::shared_ptr<CancelToken> Ptr;
+
+        static Ptr create(const Ptr &parent = nullptr)
+        {
+            return Ptr(new CancelToken(parent));
+        }
+
+        ~CancelToken() {}
+
+        void cancel()
+        {
+            _canceled.store(true, std::memory_order_release);
+        }
+
+        //自身或任一祖先被取消
+        bool isCanceled() const
+        {
+            for (auto token = this; token; token = token->_parent.get())
+            {
+                if (token->_canceled.load(std::memory_order_acquire))
+                {
+                    return true;
+                }
+            }
+            return false;
+        }
+
+        const Ptr &parent() const
+        {
+            return _parent;
+        }
+
+        //本线程当前的令牌
+        static Ptr &current()
+        {
+            static thread_local Ptr s_current;
+            return s_current;
+        }
+
+        //在作用域内替换本线程当前的令牌，传入nullptr可使内部任务不受外部令牌影响
+        class Scope
+        {
+        public:
+            Scope(Ptr token)
+            {
+                _last.swap(current());
+                current() = std::move(token);
+            }
+
+            ~Scope()
+            {
+                current().swap(_last);
+            }
+
+        private:
+            Scope(const Scope &) = delete;
+            Scope &operator=(const Scope &) = delete;
+
+        private:
+            Ptr _last;
+        };
+
+    private:
+        CancelToken(const Ptr &parent) : _parent(parent) {}
+
+    private:
+        Ptr _parent;
+        std::atomic<bool> _canceled{false};
+    };
+}
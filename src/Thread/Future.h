@@ -0,0 +1,546 @@
+#pragma once
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <future>
+#include <utility>
+#include <exception>
+#include <stdexcept>
+#include <functional>
+#include <type_traits>
+#include "Semaphore.h"
+#include "CancelToken.h"
+#include "Util/UniqueFunction.h"
+
+namespace JCToolKit
+{
+    //void结果的占位类型
+    class Unit
+    {
+    };
+
+    template <typename T>
+    class LiftVoid
+    {
+    public:
+        typedef T type;
+    };
+
+    template <>
+    class LiftVoid<void>
+    {
+    public:
+        typedef Unit type;
+    };
+
+    //延续函数fn以T(T为void时无参数)调用后的返回类型
+    template <typename F, typename T>
+    class ContinuationResult
+    {
+    public:
+        typedef decltype(std::declval<F &>()(std::declval<T>())) type;
+    };
+
+    template <typename F>
+    class ContinuationResult<F, void>
+    {
+    public:
+        typedef decltype(std::declval<F &>()()) type;
+    };
+
+    template <typename T>
+    class Future;
+
+    template <typename T>
+    class Promise;
+
+    /**
+     * Future与Promise之间的共享状态，结果、异常与延续函数都存放在同一个对象内，
+     * 由make_shared一次分配；结果与延续函数谁后到达谁负责执行延续函数，全程无锁
+     */
+    template <typename T>
+    class FutureState : public std::enable_shared_from_this<FutureState<T> >
+    {
+    public:
+        typedef std::shared_ptr<FutureState> Ptr;
+        typedef typename LiftVoid<T>::type ValueType;
+        typedef unique_function<void(FutureState &state)> CallBack;
+
+        FutureState() {}
+
+        ~FutureState()
+        {
+            if (_hasValue)
+            {
+                value().~ValueType();
+            }
+        }
+
+        template <typename U>
+        void setValue(U &&value)
+        {
+            new (&_storage) ValueType(std::forward<U>(value));
+            _hasValue = true;
+            publish();
+        }
+
+        void setException(std::exception_ptr ex)
+        {
+            _exception = std::move(ex);
+            publish();
+        }
+
+        //只能设置一次，结果已就绪时在本线程直接执行
+        void setCallBack(CallBack callBack)
+        {
+            _callBack = std::move(callBack);
+            int expect = STATE_START;
+            if (!_state.compare_exchange_strong(expect, STATE_ONLY_CALLBACK, std::memory_order_acq_rel))
+            {
+                invoke();
+            }
+        }
+
+        bool ready() const
+        {
+            auto state = _state.load(std::memory_order_acquire);
+            return state == STATE_ONLY_RESULT || state == STATE_DONE;
+        }
+
+        bool hasException() const
+        {
+            return static_cast<bool>(_exception);
+        }
+
+        const std::exception_ptr &exception() const
+        {
+            return _exception;
+        }
+
+        ValueType &value()
+        {
+            return *reinterpret_cast<ValueType *>(&_storage);
+        }
+
+        //取出结果，有异常时抛出
+        ValueType take()
+        {
+            if (_exception)
+            {
+                std::rethrow_exception(_exception);
+            }
+            return std::move(value());
+        }
+
+    private:
+        void publish()
+        {
+            int expect = STATE_START;
+            if (!_state.compare_exchange_strong(expect, STATE_ONLY_RESULT, std::memory_order_acq_rel))
+            {
+                invoke();
+            }
+        }
+
+        void invoke()
+        {
+            _state.store(STATE_DONE, std::memory_order_release);
+            //执行后立即释放延续函数捕获的资源
+            auto callBack = std::move(_callBack);
+            callBack(*this);
+        }
+
+    private:
+        enum
+        {
+            STATE_START = 0,
+            STATE_ONLY_RESULT = 1,
+            STATE_ONLY_CALLBACK = 2,
+            STATE_DONE = 3,
+        };
+
+        std::atomic<int> _state{STATE_START};
+        bool _hasValue = false;
+        std::exception_ptr _exception;
+        typename std::aligned_storage<sizeof(ValueType), alignof(ValueType)>::type _storage;
+        CallBack _callBack;
+    };
+
+    class FutureHelper
+    {
+    public:
+        //以value调用延续函数并将返回值或异常写入promise
+        template <typename R, typename T, typename F>
+        static void fulfil(Promise<R> &promise, F &fn, typename LiftVoid<T>::type &value)
+        {
+            try
+            {
+                setResult(promise, fn, value, std::is_void<T>(), std::is_void<R>());
+            }
+            catch (...)
+            {
+                promise.setException(std::current_exception());
+            }
+        }
+
+        //将state中的结果转交给延续函数
+        template <typename R, typename T, typename F>
+        static void forward(Promise<R> &promise, F &fn, FutureState<T> &state)
+        {
+            if (state.hasException())
+            {
+                promise.setException(state.exception());
+                return;
+            }
+            fulfil<R, T>(promise, fn, state.value());
+        }
+
+    private:
+        template <typename R, typename F, typename V>
+        static void setResult(Promise<R> &promise, F &fn, V &value, std::false_type, std::false_type)
+        {
+            promise.setValue(fn(std::move(value)));
+        }
+
+        template <typename R, typename F, typename V>
+        static void setResult(Promise<R> &promise, F &fn, V &value, std::false_type, std::true_type)
+        {
+            fn(std::move(value));
+            promise.setValue();
+        }
+
+        template <typename R, typename F, typename V>
+        static void setResult(Promise<R> &promise, F &fn, V &, std::true_type, std::false_type)
+        {
+            promise.setValue(fn());
+        }
+
+        template <typename R, typename F, typename V>
+        static void setResult(Promise<R> &promise, F &fn, V &, std::true_type, std::true_type)
+        {
+            fn();
+            promise.setValue();
+        }
+    };
+
+    /**
+     * 异步结果，只能被消费一次：get或then之后本对象失效
+     * T为void时结果类型为Unit
+     */
+    template <typename T>
+    class Future
+    {
+    public:
+        typedef typename LiftVoid<T>::type ValueType;
+        typedef typename FutureState<T>::Ptr StatePtr;
+
+        template <typename U>
+        friend class Future;
+
+        template <typename U>
+        friend class Promise;
+
+        template <typename U>
+        friend Future<std::vector<typename LiftVoid<U>::type> > when_all(std::vector<Future<U> > futures);
+
+        template <typename U>
+        friend Future<std::pair<size_t, typename LiftVoid<U>::type> > when_any(std::vector<Future<U> > futures);
+
+        Future() {}
+
+        Future(Future &&that) = default;
+
+        Future &operator=(Future &&that) = default;
+
+        bool valid() const
+        {
+            return static_cast<bool>(_state);
+        }
+
+        bool ready() const
+        {
+            return _state && _state->ready();
+        }
+
+        //阻塞等待结果，不能在负责产生结果的线程中调用，否则将死锁
+        ValueType get()
+        {
+            auto state = takeState();
+            if (!state->ready())
+            {
+                Semaphore sem;
+                state->setCallBack([&sem](FutureState<T> &) {
+                    sem.post();
+                });
+                sem.wait();
+            }
+            return state->take();
+        }
+
+        /**
+         * 结果就绪后在产生结果的线程中直接执行延续函数
+         * @param fn 延续函数，参数为结果(T为void时无参数)，抛出的异常将传递给返回的Future
+         * @return 延续函数返回值的Future
+         */
+        template <typename F>
+        Future<typename ContinuationResult<typename std::decay<F>::type, T>::type> then(F &&fn)
+        {
+            typedef typename std::decay<F>::type Func;
+            typedef typename ContinuationResult<Func, T>::type R;
+            Promise<R> promise;
+            auto ret = promise.getFuture();
+            //c++11不支持移动捕获，通过bind转移promise
+            takeState()->setCallBack(std::bind([](Promise<R> &promise, Func &fn, FutureState<T> &state) {
+                FutureHelper::forward<R, T>(promise, fn, state);
+            }, std::move(promise), std::forward<F>(fn), std::placeholders::_1));
+            return ret;
+        }
+
+        /**
+         * 结果就绪后在executor中执行延续函数，产生结果的线程已属于该executor时直接执行
+         * @param executor 执行器，需提供async(OperationFunction, bool maySync)
+         * @param fn 延续函数，参数为结果(T为void时无参数)，抛出的异常将传递给返回的Future
+         * @return 延续函数返回值的Future
+         */
+        template <typename ExecutorPtr, typename F>
+        Future<typename ContinuationResult<typename std::decay<F>::type, T>::type> then(const ExecutorPtr &executor, F &&fn)
+        {
+            typedef typename std::decay<F>::type Func;
+            typedef typename ContinuationResult<Func, T>::type R;
+            Promise<R> promise;
+            auto ret = promise.getFuture();
+            takeState()->setCallBack(std::bind([](ExecutorPtr &executor, Promise<R> &promise, Func &fn, FutureState<T> &state) {
+                //executor放弃执行时promise随任务析构，返回的Future得到broken_promise异常
+                //延续函数属于等待结果的一方，不随产生结果线程当前的CancelToken取消
+                CancelToken::Scope scope(nullptr);
+                executor->async(std::bind([](Promise<R> &promise, Func &fn, StatePtr &state) {
+                    FutureHelper::forward<R, T>(promise, fn, *state);
+                }, std::move(promise), std::move(fn), state.shared_from_this()), true);
+            }, executor, std::move(promise), std::forward<F>(fn), std::placeholders::_1));
+            return ret;
+        }
+
+    private:
+        explicit Future(StatePtr state) : _state(std::move(state)) {}
+
+        StatePtr takeState()
+        {
+            if (!_state)
+            {
+                throw std::future_error(std::future_errc::no_state);
+            }
+            return std::move(_state);
+        }
+
+    private:
+        StatePtr _state;
+    };
+
+    template <typename T>
+    class Promise
+    {
+    public:
+        typedef typename LiftVoid<T>::type ValueType;
+
+        Promise() : _state(std::make_shared<FutureState<T> >()) {}
+
+        Promise(Promise &&that) : _state(std::move(that._state)), _retrieved(that._retrieved) {}
+
+        Promise &operator=(Promise &&that)
+        {
+            if (this != &that)
+            {
+                breakPromise();
+                _state = std::move(that._state);
+                _retrieved = that._retrieved;
+            }
+            return *this;
+        }
+
+        //未设置结果就析构时，Future得到broken_promise异常
+        ~Promise()
+        {
+            breakPromise();
+        }
+
+        Future<T> getFuture()
+        {
+            if (!_state)
+            {
+                throw std::future_error(std::future_errc::no_state);
+            }
+            if (_retrieved)
+            {
+                throw std::future_error(std::future_errc::future_already_retrieved);
+            }
+            _retrieved = true;
+            return Future<T>(_state);
+        }
+
+        template <typename U>
+        void setValue(U &&value)
+        {
+            takeState()->setValue(std::forward<U>(value));
+        }
+
+        template <typename U = T>
+        typename std::enable_if<std::is_void<U>::value>::type setValue()
+        {
+            takeState()->setValue(Unit());
+        }
+
+        void setException(std::exception_ptr ex)
+        {
+            takeState()->setException(std::move(ex));
+        }
+
+    private:
+        Promise(const Promise &) = delete;
+        Promise &operator=(const Promise &) = delete;
+
+        typename FutureState<T>::Ptr takeState()
+        {
+            if (!_state)
+            {
+                throw std::future_error(std::future_errc::promise_already_satisfied);
+            }
+            return std::move(_state);
+        }
+
+        void breakPromise()
+        {
+            if (_state)
+            {
+                takeState()->setException(std::make_exception_ptr(std::future_error(std::future_errc::broken_promise)));
+            }
+        }
+
+    private:
+        typename FutureState<T>::Ptr _state;
+        bool _retrieved = false;
+    };
+
+    template <typename T>
+    Future<typename std::decay<T>::type> makeReadyFuture(T &&value)
+    {
+        Promise<typename std::decay<T>::type> promise;
+        auto ret = promise.getFuture();
+        promise.setValue(std::forward<T>(value));
+        return ret;
+    }
+
+    /**
+     * 在executor中执行fn，并以Future返回其结果
+     * @param executor 执行器，需提供async(OperationFunction, bool maySync)
+     * @param fn 无参数的任务，抛出的异常将传递给返回的Future
+     * @param maySync 当前线程属于该执行器时是否直接执行
+     */
+    template <typename ExecutorPtr, typename F>
+    Future<typename ContinuationResult<typename std::decay<F>::type, void>::type> asyncFuture(const ExecutorPtr &executor, F &&fn, bool maySync = true)
+    {
+        typedef typename std::decay<F>::type Func;
+        typedef typename ContinuationResult<Func, void>::type R;
+        Promise<R> promise;
+        auto ret = promise.getFuture();
+        executor->async(std::bind([](Promise<R> &promise, Func &fn) {
+            Unit unit;
+            FutureHelper::fulfil<R, void>(promise, fn, unit);
+        }, std::move(promise), std::forward<F>(fn)), maySync);
+        return ret;
+    }
+
+    /**
+     * 所有Future都就绪后按原顺序返回全部结果，任意一个出现异常时返回第一个异常
+     */
+    template <typename T>
+    Future<std::vector<typename LiftVoid<T>::type> > when_all(std::vector<Future<T> > futures)
+    {
+        typedef typename LiftVoid<T>::type ValueType;
+        class Context
+        {
+        public:
+            Promise<std::vector<ValueType> > _promise;
+            std::vector<typename FutureState<T>::Ptr> _states;
+            std::atomic<size_t> _remain{0};
+        };
+
+        auto context = std::make_shared<Context>();
+        auto ret = context->_promise.getFuture();
+        if (futures.empty())
+        {
+            context->_promise.setValue(std::vector<ValueType>());
+            return ret;
+        }
+
+        context->_states.reserve(futures.size());
+        for (auto &future : futures)
+        {
+            context->_states.emplace_back(future.takeState());
+        }
+        context->_remain = futures.size();
+        for (auto &state : context->_states)
+        {
+            state->setCallBack([context](FutureState<T> &) {
+                if (--context->_remain)
+                {
+                    return;
+                }
+                std::vector<ValueType> values;
+                values.reserve(context->_states.size());
+                for (auto &state : context->_states)
+                {
+                    if (state->hasException())
+                    {
+                        context->_promise.setException(state->exception());
+                        return;
+                    }
+                    values.emplace_back(std::move(state->value()));
+                }
+                context->_promise.setValue(std::move(values));
+            });
+        }
+        return ret;
+    }
+
+    /**
+     * 任意一个Future就绪后返回其下标与结果(或异常)
+     */
+    template <typename T>
+    Future<std::pair<size_t, typename LiftVoid<T>::type> > when_any(std::vector<Future<T> > futures)
+    {
+        typedef typename LiftVoid<T>::type ValueType;
+        class Context
+        {
+        public:
+            Promise<std::pair<size_t, ValueType> > _promise;
+            std::atomic<bool> _done{false};
+        };
+
+        auto context = std::make_shared<Context>();
+        auto ret = context->_promise.getFuture();
+        if (futures.empty())
+        {
+            context->_promise.setException(std::make_exception_ptr(std::invalid_argument("when_any: empty futures")));
+            return ret;
+        }
+
+        for (size_t i = 0; i < futures.size(); ++i)
+        {
+            futures[i].takeState()->setCallBack([context, i](FutureState<T> &state) {
+                if (context->_done.exchange(true))
+                {
+                    return;
+                }
+                if (state.hasException())
+                {
+                    context->_promise.setException(state.exception());
+                    return;
+                }
+                context->_promise.setValue(std::make_pair(i, std::move(state.value())));
+            });
+        }
+        return ret;
+    }
+}
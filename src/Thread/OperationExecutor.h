@@ -1,12 +1,21 @@
 #pragma once
 
 #include <memory>
+#include <atomic>
 #include <functional>
 #include <vector>
 #include <thread>
+#include <mutex>
+#include <string>
+#include <algorithm>
+#include <iterator>
+#include <unordered_map>
 #include "Semaphore.h"
+#include "CancelToken.h"
 #include "Util/List.h"
 #include "Util/Utilities.h"
+#include "Util/ThreadLocalAllocator.h"
+#include "Util/UniqueFunction.h"
 
 namespace JCToolKit
 {
@@ -26,11 +35,12 @@ namespace JCToolKit
     {
     public:
         typedef std::shared_ptr<OperationCancelableImp> Ptr;
-        typedef std::function<T(ArgTypes...)> FunctionType;
+        typedef unique_function<T(ArgTypes...)> FunctionType;
         ~OperationCancelableImp() = default;
 
+        //绑定创建时本线程当前的CancelToken
         template <typename FUNC>
-        OperationCancelableImp(FUNC &&op)
+        OperationCancelableImp(FUNC &&op) : _token(CancelToken::current())
         {
             _strongOp = std::make_shared<FunctionType>(std::forward<FUNC>(op));
             _weakOp = _strongOp;
@@ -43,7 +53,7 @@ namespace JCToolKit
 
         operator bool()
         {
-            return _strongOp && *_strongOp;
+            return _strongOp && *_strongOp && !(_token && _token->isCanceled());
         }
 
         void operator=(std::nullptr_t)
@@ -54,11 +64,20 @@ namespace JCToolKit
         T operator()(ArgTypes... args) const
         {
             auto strongOp = _weakOp.lock();
-            if (strongOp && *strongOp)
+            if (!strongOp || !*strongOp)
+            {
+                return defaultValue<T>();
+            }
+            if (!_token)
             {
                 return (*strongOp)(std::forward<ArgTypes>(args)...);
             }
-            return defaultValue<T>();
+            if (_token->isCanceled())
+            {
+                return defaultValue<T>();
+            }
+            CancelToken::Scope scope(_token);
+            return (*strongOp)(std::forward<ArgTypes>(args)...);
         }
 
         template <typename C>
@@ -80,12 +99,392 @@ namespace JCToolKit
         }
 
     private:
+        CancelToken::Ptr _token;
         std::shared_ptr<FunctionType> _strongOp;
         std::weak_ptr<FunctionType> _weakOp;
     };
 
-    typedef std::function<void()> OperationFunction;
-    typedef OperationCancelableImp<void()> Operation;
+    typedef unique_function<void()> OperationFunction;
+
+    /**
+     * 异步任务对象，任务函数(捕获不超过64字节时内联存放)、取消标记与队列链接都在同一个对象内，
+     * 通过create创建时只需一次内存分配，同线程回收后再创建则无需分配
+     * 取消后任务不再执行，但其捕获的资源要等任务出队后才释放
+     * 创建时本线程当前的CancelToken被取消后同样不再执行
+     */
+    class Operation : public OperationCancelable
+    {
+    public:
+        typedef std::shared_ptr<Operation> Ptr;
+        friend class OperationList;
+
+        template <typename FUNC>
+        Operation(FUNC &&op) : _op(std::forward<FUNC>(op)), _token(CancelToken::current()) {}
+
+        ~Operation() = default;
+
+        template <typename FUNC>
+        static Ptr create(FUNC &&op)
+        {
+            return std::allocate_shared<Operation>(ThreadLocalAllocator<Operation>(), std::forward<FUNC>(op));
+        }
+
+        void cancel() override
+        {
+            _canceled.store(true, std::memory_order_release);
+        }
+
+        operator bool()
+        {
+            return !_canceled.load(std::memory_order_acquire) && _op && !(_token && _token->isCanceled());
+        }
+
+        void operator=(std::nullptr_t)
+        {
+            cancel();
+        }
+
+        void operator()() const
+        {
+            if (_canceled.load(std::memory_order_acquire) || !_op)
+            {
+                return;
+            }
+            if (!_token)
+            {
+                _op();
+                return;
+            }
+            if (!_token->isCanceled())
+            {
+                //任务中再投递的任务继承同一令牌
+                CancelToken::Scope scope(_token);
+                _op();
+            }
+        }
+
+    private:
+        OperationFunction _op;
+        CancelToken::Ptr _token;
+        std::atomic<bool> _canceled{false};
+        //入队期间持有自身引用，出队时释放
+        Operation *_next = nullptr;
+        Ptr _self;
+    };
+
+    //Operation的侵入式链表，接口与List<Operation::Ptr>一致，入队不需要额外分配链表节点
+    class OperationList
+    {
+    public:
+        OperationList() {}
+
+        OperationList(OperationList &&list)
+        {
+            swap(list);
+        }
+
+        ~OperationList()
+        {
+            clear();
+        }
+
+        void clear()
+        {
+            while (_front)
+            {
+                pop_front();
+            }
+        }
+
+        template <typename FUN>
+        void for_each(FUN &&fun)
+        {
+            auto ptr = _front;
+            while (ptr)
+            {
+                auto next = ptr->_next;
+                fun(ptr->_self);
+                ptr = next;
+            }
+        }
+
+        size_t size() const
+        {
+            return _size;
+        }
+
+        bool empty() const
+        {
+            return _size == 0;
+        }
+
+        void emplace_front(Operation::Ptr op)
+        {
+            auto ptr = op.get();
+            ptr->_self = std::move(op);
+            ptr->_next = _front;
+            _front = ptr;
+            if (!_back)
+            {
+                _back = ptr;
+            }
+            ++_size;
+        }
+
+        void emplace_back(Operation::Ptr op)
+        {
+            auto ptr = op.get();
+            ptr->_self = std::move(op);
+            ptr->_next = nullptr;
+            if (_back)
+            {
+                _back->_next = ptr;
+            }
+            else
+            {
+                _front = ptr;
+            }
+            _back = ptr;
+            ++_size;
+        }
+
+        Operation::Ptr &front() const
+        {
+            return _front->_self;
+        }
+
+        Operation::Ptr &back() const
+        {
+            return _back->_self;
+        }
+
+        void pop_front()
+        {
+            if (!_front)
+            {
+                return;
+            }
+            auto ptr = _front;
+            _front = ptr->_next;
+            if (!_front)
+            {
+                _back = nullptr;
+            }
+            --_size;
+            ptr->_next = nullptr;
+            //最后才释放自身引用，之后ptr可能已被销毁
+            Operation::Ptr self;
+            self.swap(ptr->_self);
+        }
+
+        void swap(OperationList &list)
+        {
+            std::swap(_front, list._front);
+            std::swap(_back, list._back);
+            std::swap(_size, list._size);
+        }
+
+        void append(OperationList &list)
+        {
+            if (list.empty())
+            {
+                return;
+            }
+            if (_back)
+            {
+                _back->_next = list._front;
+            }
+            else
+            {
+                _front = list._front;
+            }
+            _back = list._back;
+            _size += list._size;
+
+            list._front = list._back = nullptr;
+            list._size = 0;
+        }
+
+    private:
+        OperationList(const OperationList &) = delete;
+        OperationList &operator=(const OperationList &) = delete;
+
+    private:
+        Operation *_front = nullptr;
+        Operation *_back = nullptr;
+        size_t _size = 0;
+    };
+
+    //批量创建Operation对象，contiguous为true时所有对象分配在同一块内存上并共享引用计数
+    inline std::vector<Operation::Ptr> createOperations(std::vector<OperationFunction> &operations, bool contiguous)
+    {
+        std::vector<Operation::Ptr> ret;
+        ret.reserve(operations.size());
+        if (!contiguous)
+        {
+            for (auto &operation : operations)
+            {
+                ret.emplace_back(Operation::create(std::move(operation)));
+            }
+            return ret;
+        }
+
+        class OperationBlock : public noncopyable
+        {
+        public:
+            typedef std::aligned_storage<sizeof(Operation), alignof(Operation)>::type Storage;
+
+            OperationBlock(size_t size) : _storage(new Storage[size]) {}
+
+            ~OperationBlock()
+            {
+                for (size_t i = 0; i < _count; ++i)
+                {
+                    at(i)->~Operation();
+                }
+                delete[] _storage;
+            }
+
+            Operation *emplace(OperationFunction &&operation)
+            {
+                auto ptr = new (_storage + _count) Operation(std::move(operation));
+                ++_count;
+                return ptr;
+            }
+
+        private:
+            Operation *at(size_t pos)
+            {
+                return reinterpret_cast<Operation *>(_storage + pos);
+            }
+
+        private:
+            Storage *_storage;
+            size_t _count = 0;
+        };
+
+        auto block = std::make_shared<OperationBlock>(operations.size());
+        for (auto &operation : operations)
+        {
+            //别名构造，所有Operation共享block的生命周期
+            ret.emplace_back(block, block->emplace(std::move(operation)));
+        }
+        return ret;
+    }
+
+    typedef enum
+    {
+        COALESCE_REPLACE = 0, //新提交的任务替换尚未执行的任务
+        COALESCE_MERGE = 1,   //丢弃新提交的任务，并入尚未执行的任务
+    } CoalesceMode;
+
+    //按key合并提交的任务表，同一个key同时最多只有一个待执行任务，立即执行与防抖的任务分别按key合并
+    class CoalesceTable
+    {
+    public:
+        typedef std::shared_ptr<CoalesceTable> Ptr;
+
+        class Slot
+        {
+        public:
+            typedef std::shared_ptr<Slot> Ptr;
+
+            //尚未被取消的待执行任务
+            bool pending()
+            {
+                return (_operation && *_operation) || (_delayOperation && *_delayOperation);
+            }
+
+        public:
+            OperationFunction _op;
+            Operation::Ptr _operation;
+            OperationCancelableImp<uint64_t(void)>::Ptr _delayOperation;
+            //防抖截止时间，毫秒
+            uint64_t _deadlineMs = 0;
+        };
+
+        /**
+         * 需在_mtx锁内调用
+         * @param key 任务标识
+         * @param op 新提交的任务，未被合并时移入新建的槽位
+         * @param mode 合并方式
+         * @param slot 返回待执行任务所在的槽位
+         * @param debounce 是否为防抖任务，与立即执行的任务互不合并
+         * @return true表示已合并到待执行任务中；false表示新建了槽位，调用者需在锁内为其提交任务
+         */
+        bool coalesce(const std::string &key, OperationFunction &op, CoalesceMode mode, Slot::Ptr &slot, bool debounce = false)
+        {
+            sweep();
+            auto &ref = _slots[debounce][key];
+            if (ref && ref->pending())
+            {
+                if (mode == COALESCE_REPLACE)
+                {
+                    ref->_op = std::move(op);
+                }
+                ++_coalescedCount;
+                slot = ref;
+                return true;
+            }
+            ref = std::make_shared<Slot>();
+            ref->_op = std::move(op);
+            slot = ref;
+            return false;
+        }
+
+        //需在_mtx锁内调用，取出待执行任务，此后同key的提交将重新排队
+        OperationFunction take(const std::string &key, const Slot::Ptr &slot, bool debounce = false)
+        {
+            auto &slots = _slots[debounce];
+            auto it = slots.find(key);
+            if (it != slots.end() && it->second == slot)
+            {
+                slots.erase(it);
+            }
+            return std::move(slot->_op);
+        }
+
+        uint64_t coalescedCount() const
+        {
+            return _coalescedCount.load();
+        }
+
+    private:
+        //槽位数增长一倍时清理已取消的槽位，被取消的任务不会再执行，否则其key不再提交时将一直留在表中
+        void sweep()
+        {
+            if (_slots[0].size() + _slots[1].size() < _sweepSize)
+            {
+                return;
+            }
+            for (auto &slots : _slots)
+            {
+                for (auto it = slots.begin(); it != slots.end();)
+                {
+                    if (!it->second || !it->second->pending())
+                    {
+                        it = slots.erase(it);
+                        continue;
+                    }
+                    ++it;
+                }
+            }
+            _sweepSize = std::max<size_t>(64, (_slots[0].size() + _slots[1].size()) * 2);
+        }
+
+    public:
+        std::mutex _mtx;
+
+    private:
+        size_t _sweepSize = 64;
+        //下标0为立即执行的任务，1为防抖任务
+        std::unordered_map<std::string, Slot::Ptr> _slots[2];
+        std::atomic<uint64_t> _coalescedCount{0};
+    };
+
+#if defined(ENABLE_COROUTINE)
+    class ScheduleAwaiter;
+#endif
 
     class OperationExecutorProtocol
     {
@@ -100,9 +499,92 @@ namespace JCToolKit
             return async(std::move(operation), maySync);
         }
 
+        /**
+         * 批量提交任务，子类应在一次加锁内入队并只唤醒一次
+         * @param operations 任务列表
+         * @param maySync 当前线程属于该执行器时是否直接同步执行
+         * @param contiguous 是否将Operation对象连续分配在同一块内存上
+         * @return 每个任务对应的Operation，同步执行时返回空列表
+         */
+        virtual std::vector<Operation::Ptr> asyncBatch(std::vector<OperationFunction> operations, bool maySync = true, bool contiguous = false)
+        {
+            //默认实现逐个投递，返回的Operation按contiguous分配，仍可用于取消
+            auto ret = createOperations(operations, contiguous);
+            for (auto &operation : ret)
+            {
+                async([operation]() {
+                    (*operation)();
+                }, maySync);
+            }
+            return ret;
+        }
+
+        //从[begin, end)中移出任务批量提交，可传入只可移动的可调用对象
+        template <typename Iterator>
+        std::vector<Operation::Ptr> asyncBatch(Iterator begin, Iterator end, bool maySync = true, bool contiguous = false)
+        {
+            std::vector<OperationFunction> operations;
+            for (auto it = std::make_move_iterator(begin); it != std::make_move_iterator(end); ++it)
+            {
+                operations.emplace_back(*it);
+            }
+            return asyncBatch(std::move(operations), maySync, contiguous);
+        }
+
+        /**
+         * 按key合并提交，同一个key最多只有一个任务在排队，适合重复提交的刷新类任务
+         * 任务开始执行后再提交同key任务会重新排队；与EventPoller防抖版本的同名key互不合并
+         * @param key 任务标识
+         * @param operation 任务
+         * @param mode 已有同key任务在排队时，替换其任务函数或丢弃本次提交
+         * @return 排队中的任务，可用于取消
+         */
+        Operation::Ptr asyncCoalesce(const std::string &key, OperationFunction operation, CoalesceMode mode = COALESCE_REPLACE)
+        {
+            auto table = _coalesceTable;
+            std::lock_guard<std::mutex> lck(table->_mtx);
+            CoalesceTable::Slot::Ptr slot;
+            if (table->coalesce(key, operation, mode, slot))
+            {
+                return slot->_operation;
+            }
+            //槽位持有任务，任务只能弱引用槽位，否则形成循环引用
+            std::weak_ptr<CoalesceTable::Slot> weakSlot = slot;
+            slot->_operation = async([table, key, weakSlot]() {
+                OperationFunction op;
+                {
+                    std::lock_guard<std::mutex> lck(table->_mtx);
+                    auto slot = weakSlot.lock();
+                    if (!slot)
+                    {
+                        return;
+                    }
+                    op = table->take(key, slot);
+                }
+                if (op)
+                {
+                    op();
+                }
+            }, false);
+            return slot->_operation;
+        }
+
+        //被合并掉的提交次数
+        uint64_t coalescedCount() const
+        {
+            return _coalesceTable->coalescedCount();
+        }
+
+#if defined(ENABLE_COROUTINE)
+        //协程中co_await executor->schedule()切换到本执行器继续执行，定义见Poller/Coroutine.h
+        ScheduleAwaiter schedule();
+#endif
+
         void sync(const OperationFunction &operation)
         {
             Semaphore sem;
+            //同步任务不受当前CancelToken影响，否则被跳过后将永远等待
+            CancelToken::Scope scope(nullptr);
             auto ret = async([&]() {
                 onceToken token(nullptr, [&]() {
                     //通过RAII原理防止抛异常导致不执行这句代码
@@ -119,6 +601,8 @@ namespace JCToolKit
         void syncFirst(const OperationFunction &operation)
         {
             Semaphore sem;
+            //同步任务不受当前CancelToken影响，否则被跳过后将永远等待
+            CancelToken::Scope scope(nullptr);
             auto ret = asyncFirst([&]() {
                 onceToken token(nullptr, [&]() {
                     //通过RAII原理防止抛异常导致不执行这句代码
@@ -131,6 +615,9 @@ namespace JCToolKit
                 sem.wait();
             }
         }
+
+    protected:
+        CoalesceTable::Ptr _coalesceTable = std::make_shared<CoalesceTable>();
     };
 
     class ThreadLoad
@@ -138,7 +625,7 @@ namespace JCToolKit
     public:
         ThreadLoad(uint64_t maxSize, uint64_t maxUsec)
         {
-            _lastSleepTime = _lastWakeTime = getCurrentMicrosecond();
+            _lastTime = getCurrentMicrosecond();
             _maxSize = maxSize;
             _maxUsec = maxUsec;
         }
@@ -146,31 +633,48 @@ namespace JCToolKit
 
         void startSleep()
         {
-            std::lock_guard<std::mutex> lck(_mutex);
-            _sleeping = true;
+            switchState(STATE_SLEEP);
+        }
 
-            auto currentTime = getCurrentMicrosecond();
-            auto runTime = currentTime - _lastWakeTime;
-            _lastSleepTime = currentTime;
+        //空闲自旋等待，自旋时间单独统计，不计入load
+        void startSpin()
+        {
+            switchState(STATE_SPIN);
+        }
 
-            _timeList.emplace_back(runTime, false);
+        void wakeUp()
+        {
+            switchState(STATE_RUN);
+        }
 
-            if (_timeList.size() > _maxSize)
-            {
-                _timeList.pop_front();
-            }
+        //执行任务时间占比
+        int load()
+        {
+            return percent(STATE_RUN);
         }
 
-        void wakeUp()
+        //空闲自旋时间占比
+        int spinLoad()
         {
-            std::lock_guard<std::mutex> lck(_mutex);
-            _sleeping = false;
+            return percent(STATE_SPIN);
+        }
 
-            auto currentTime = getCurrentMicrosecond();
-            auto runTime = currentTime - _lastSleepTime;
-            _lastWakeTime = currentTime;
+    private:
+        enum State
+        {
+            STATE_RUN = 0,
+            STATE_SLEEP,
+            STATE_SPIN,
+            STATE_MAX
+        };
 
-            _timeList.emplace_back(runTime, true);
+        void switchState(State state)
+        {
+            std::lock_guard<std::mutex> lck(_mutex);
+            auto currentTime = getCurrentMicrosecond();
+            _timeList.emplace_back(currentTime - _lastTime, _state);
+            _lastTime = currentTime;
+            _state = state;
 
             if (_timeList.size() > _maxSize)
             {
@@ -178,76 +682,55 @@ namespace JCToolKit
             }
         }
 
-        int load()
+        int percent(State state)
         {
             std::lock_guard<std::mutex> lck(_mutex);
 
-            uint64_t totalSleepTime = 0;
-            uint64_t totalRunTime = 0;
-
+            uint64_t totalTime[STATE_MAX] = {0};
             _timeList.for_each([&](const TimeRecord &record) {
-                if (record._isSleep)
-                {
-                    totalSleepTime += record._time;
-                }
-                else
-                {
-                    totalRunTime += record._time;
-                }
+                totalTime[record._state] += record._time;
             });
+            totalTime[_state] += (getCurrentMicrosecond() - _lastTime);
 
-            if (_sleeping)
+            uint64_t total = 0;
+            for (auto time : totalTime)
             {
-                totalSleepTime += (getCurrentMicrosecond() - _lastSleepTime);
+                total += time;
             }
-            else
-            {
-                totalRunTime += (getCurrentMicrosecond() - _lastWakeTime);
-            }
-
-            auto totalTime = totalRunTime + totalSleepTime;
 
-            while (_timeList.size() != 0 && (totalTime > _maxUsec || _timeList.size() > _maxSize))
+            while (_timeList.size() != 0 && (total > _maxUsec || _timeList.size() > _maxSize))
             {
                 TimeRecord &record = _timeList.front();
-                if (record._isSleep)
-                {
-                    totalSleepTime -= record._time;
-                }
-                else
-                {
-                    totalRunTime -= record._time;
-                }
-                totalTime -= record._time;
+                totalTime[record._state] -= record._time;
+                total -= record._time;
                 _timeList.pop_front();
             }
-            if (totalTime == 0)
+            if (total == 0)
             {
                 return 0;
             }
-            return totalRunTime * 100 / totalTime;
+            return totalTime[state] * 100 / total;
         }
 
     private:
         class TimeRecord
         {
         public:
-            TimeRecord(uint64_t time, bool isSleep)
+            TimeRecord(uint64_t time, State state)
             {
                 _time = time;
-                _isSleep = isSleep;
+                _state = state;
             }
 
         public:
             uint64_t _time;
-            bool _isSleep;
+            State _state;
         };
 
     private:
-        uint64_t _lastSleepTime;
-        uint64_t _lastWakeTime;
+        uint64_t _lastTime;
         List<TimeRecord> _timeList;
-        bool _sleeping = true;
+        State _state = STATE_SLEEP;
         uint64_t _maxSize;
         uint64_t _maxUsec;
         std::mutex _mutex;
@@ -262,31 +745,42 @@ namespace JCToolKit
         ~OperationExecutor() {}
     };
 
+    /**
+     * 执行器集合，执行器列表以写时复制的快照保存，
+     * 选取执行器时只需原子地取一次快照，增删执行器不会阻塞正在选取的线程
+     */
     class OperationExecutorProvider
     {
     public:
         typedef std::shared_ptr<OperationExecutorProvider> Ptr;
-        OperationExecutorProvider() {}
+        typedef std::vector<OperationExecutor::Ptr> ExecutorList;
+        OperationExecutorProvider() : _executors(std::make_shared<ExecutorList>()) {}
         ~OperationExecutorProvider() {}
 
+        //执行器为空时返回nullptr
         OperationExecutor::Ptr getExecutor()
         {
+            auto executors = getExecutors();
+            if (executors->empty())
+            {
+                return nullptr;
+            }
             size_t pos = _pos;
-            if (pos >= _executors.size())
+            if (pos >= executors->size())
             {
                 pos = 0;
             }
-            auto minLoadExecutor = _executors[pos];
+            auto minLoadExecutor = (*executors)[pos];
             auto minLoad = minLoadExecutor->load();
 
-            for (size_t i = 0; i < _executors.size(); ++i, ++pos)
+            for (size_t i = 0; i < executors->size(); ++i, ++pos)
             {
-                if (pos >= _executors.size())
+                if (pos >= executors->size())
                 {
                     pos = 0;
                 }
 
-                auto executor = _executors[pos];
+                auto executor = (*executors)[pos];
                 auto load = executor->load();
 
                 if (minLoad > load)
@@ -305,9 +799,10 @@ namespace JCToolKit
 
         std::vector<int> getExecutorLoad()
         {
-            std::vector<int> vec(_executors.size());
+            auto executors = getExecutors();
+            std::vector<int> vec(executors->size());
             int i = 0;
-            for (auto &executor : _executors)
+            for (auto &executor : *executors)
             {
                 vec[i] = executor->load();
                 ++i;
@@ -318,25 +813,62 @@ namespace JCToolKit
         template <typename FUNC>
         void for_each(FUNC &&func)
         {
-            for (auto &executor : _executors)
+            auto executors = getExecutors();
+            for (auto &executor : *executors)
             {
                 func(executor);
             }
         }
 
+        size_t getExecutorSize()
+        {
+            return getExecutors()->size();
+        }
+
     protected:
         template <typename FUNC>
         void createExecutors(FUNC &&func, int threadNum = std::thread::hardware_concurrency())
         {
-            for (size_t i = 0; i < threadNum; i++)
+            for (int i = 0; i < threadNum; i++)
+            {
+                addExecutor(func());
+            }
+        }
+
+        //当前执行器列表的快照
+        std::shared_ptr<const ExecutorList> getExecutors() const
+        {
+            return std::atomic_load(&_executors);
+        }
+
+        void addExecutor(const OperationExecutor::Ptr &executor)
+        {
+            std::lock_guard<std::mutex> lck(_mtxExecutors);
+            auto executors = std::make_shared<ExecutorList>(*_executors);
+            executors->emplace_back(executor);
+            std::atomic_store(&_executors, std::shared_ptr<const ExecutorList>(executors));
+        }
+
+        //返回是否找到并移除
+        bool removeExecutor(const OperationExecutor::Ptr &executor)
+        {
+            std::lock_guard<std::mutex> lck(_mtxExecutors);
+            auto executors = std::make_shared<ExecutorList>(*_executors);
+            auto it = std::find(executors->begin(), executors->end(), executor);
+            if (it == executors->end())
             {
-                _executors.emplace_back(func());
+                return false;
             }
+            executors->erase(it);
+            std::atomic_store(&_executors, std::shared_ptr<const ExecutorList>(executors));
+            return true;
         }
 
     protected:
         size_t _pos = 0;
-        std::vector<OperationExecutor::Ptr> _executors;
+        //只在_mtxExecutors锁内替换
+        std::mutex _mtxExecutors;
+        std::shared_ptr<const ExecutorList> _executors;
     };
 
 }
\ No newline at end of file
@@ -2,6 +2,8 @@
 
 #include <list>
 #include <deque>
+#include <vector>
+#include <algorithm>
 #include <atomic>
 #include <mutex>
 #include <functional>
@@ -10,7 +12,8 @@
 
 namespace JCToolKit
 {
-    template <typename T>
+    //Container为链表类型，Operation::Ptr可使用侵入式的OperationList
+    template <typename T, typename Container = List<T> >
     class OperationQueue
     {
     public:
@@ -34,32 +37,130 @@ namespace JCToolKit
             _sem.post();
         }
 
+        //批量入队，只加一次锁、唤醒一次
+        template <typename Iterator>
+        void push_back_batch(Iterator begin, Iterator end)
+        {
+            Container batch;
+            for (; begin != end; ++begin)
+            {
+                batch.emplace_back(*begin);
+            }
+            auto count = batch.size();
+            if (count == 0)
+            {
+                return;
+            }
+            {
+                std::lock_guard<decltype(_mutex)> lock(_mutex);
+                _queue.append(batch);
+            }
+            _sem.post(count);
+        }
+
+        //按截止时间(微秒时间戳)入队，截止时间越早越先出队，且优先于普通任务
+        template <typename FUNC>
+        void push_deadline(FUNC &&func, uint64_t deadline)
+        {
+            {
+                std::lock_guard<decltype(_mutex)> lock(_mutex);
+                _deadlineQueue.emplace_back(deadline, _deadlineSeq++, std::forward<FUNC>(func));
+                std::push_heap(_deadlineQueue.begin(), _deadlineQueue.end(), DeadlineCompare());
+            }
+            _sem.post();
+        }
+
         void push_exit(size_t n)
         {
             _sem.post(n);
         }
 
-        bool get_operation(T &op)
+        //连续取出interval个截止时间任务后，普通任务非空时先取一个普通任务，避免其被持续饿死；0为不限制
+        void set_fifo_interval(size_t interval)
+        {
+            _fifoInterval = interval;
+        }
+
+        //deadline返回该任务的截止时间，普通任务为UINT64_MAX
+        bool get_operation(T &op, uint64_t *deadline = nullptr)
         {
             _sem.wait();
             std::lock_guard<decltype(_mutex)> lock(_mutex);
+            auto interval = _fifoInterval.load(std::memory_order_relaxed);
+            bool fifoTurn = interval && _deadlineStreak >= interval && _queue.size() != 0;
+            if (!_deadlineQueue.empty() && !fifoTurn)
+            {
+                ++_deadlineStreak;
+                std::pop_heap(_deadlineQueue.begin(), _deadlineQueue.end(), DeadlineCompare());
+                auto &item = _deadlineQueue.back();
+                op = std::move(item._op);
+                if (deadline)
+                {
+                    *deadline = item._deadline;
+                }
+                _deadlineQueue.pop_back();
+                return true;
+            }
             if (_queue.size() == 0)
             {
                 return false;
             }
+            _deadlineStreak = 0;
             op = std::move(_queue.front());
             _queue.pop_front();
+            if (deadline)
+            {
+                *deadline = UINT64_MAX;
+            }
             return true;
         }
 
+        //是否有待取出的任务(或退出信号)，无锁，供空闲自旋时轮询
+        bool ready() const
+        {
+            return _sem.count() != 0;
+        }
+
         size_t size() const
         {
             std::lock_guard<decltype(_mutex)> lock(_mutex);
-            return _queue.size();
+            return _queue.size() + _deadlineQueue.size();
         }
 
     private:
-        List<T> _queue;
+        class DeadlineItem
+        {
+        public:
+            template <typename FUNC>
+            DeadlineItem(uint64_t deadline, uint64_t seq, FUNC &&func) : _deadline(deadline), _seq(seq), _op(std::forward<FUNC>(func)) {}
+
+        public:
+            uint64_t _deadline;
+            uint64_t _seq;
+            T _op;
+        };
+
+        //小顶堆，截止时间相同时按入队顺序
+        class DeadlineCompare
+        {
+        public:
+            bool operator()(const DeadlineItem &a, const DeadlineItem &b) const
+            {
+                if (a._deadline != b._deadline)
+                {
+                    return a._deadline > b._deadline;
+                }
+                return a._seq > b._seq;
+            }
+        };
+
+    private:
+        Container _queue;
+        std::vector<DeadlineItem> _deadlineQueue;
+        uint64_t _deadlineSeq = 0;
+        //连续取出的截止时间任务个数
+        size_t _deadlineStreak = 0;
+        std::atomic<size_t> _fifoInterval{8};
         mutable std::mutex _mutex;
         Semaphore _sem;
     };
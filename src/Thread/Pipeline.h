@@ -0,0 +1,541 @@
+#pragma once
+
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <memory>
+#include <string>
+#include <vector>
+#include <iostream>
+#include <functional>
+#include <condition_variable>
+#include "ThreadPool.h"
+#include "Semaphore.h"
+#include "Util/Utilities.h"
+
+namespace JCToolKit
+{
+    typedef enum
+    {
+        PIPELINE_UNORDERED = 0, //各批次处理完立即交给下一阶段
+        PIPELINE_ORDERED = 1,   //按进入本阶段的顺序交给下一阶段
+    } PipelineOrdering;
+
+    /**
+     * 阶段之间的有界队列，以批为单位存放在定长环形数组中
+     * 满时push阻塞，形成对上游的反压；入队时分配连续序号，供有序阶段重排
+     */
+    template <typename T>
+    class PipelineQueue
+    {
+    public:
+        typedef std::shared_ptr<PipelineQueue> Ptr;
+
+        class Batch
+        {
+        public:
+            uint64_t _seq = 0;
+            std::vector<T> _items;
+        };
+
+        //capacity:最多缓存的批次数
+        explicit PipelineQueue(size_t capacity) : _ring(capacity ? capacity : 1) {}
+
+        //队列已关闭时返回false
+        bool push(std::vector<T> items)
+        {
+            std::unique_lock<std::mutex> lck(_mtx);
+            while (_count == _ring.size() && !_closed)
+            {
+                _notFull.wait(lck);
+            }
+            if (_closed)
+            {
+                return false;
+            }
+            auto &batch = _ring[(_head + _count) % _ring.size()];
+            batch._seq = _nextSeq++;
+            batch._items = std::move(items);
+            _itemCount += batch._items.size();
+            ++_count;
+            _notEmpty.notify_one();
+            return true;
+        }
+
+        //队列已关闭且取空时返回false
+        bool pop(Batch &batch)
+        {
+            std::unique_lock<std::mutex> lck(_mtx);
+            while (_count == 0 && !_closed)
+            {
+                _notEmpty.wait(lck);
+            }
+            if (_count == 0)
+            {
+                return false;
+            }
+            auto &front = _ring[_head];
+            batch._seq = front._seq;
+            batch._items = std::move(front._items);
+            front._items = std::vector<T>();
+            _itemCount -= batch._items.size();
+            _head = (_head + 1) % _ring.size();
+            --_count;
+            _notFull.notify_one();
+            return true;
+        }
+
+        //关闭后不能再push，已入队的批次仍可取出
+        void close()
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            _closed = true;
+            _notFull.notify_all();
+            _notEmpty.notify_all();
+        }
+
+        //排队中的批次数
+        size_t size()
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            return _count;
+        }
+
+        //排队中的数据个数
+        size_t itemCount()
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            return _itemCount;
+        }
+
+        size_t capacity() const
+        {
+            return _ring.size();
+        }
+
+    private:
+        std::mutex _mtx;
+        std::condition_variable _notFull;
+        std::condition_variable _notEmpty;
+        std::vector<Batch> _ring;
+        size_t _head = 0;
+        size_t _count = 0;
+        size_t _itemCount = 0;
+        uint64_t _nextSeq = 0;
+        bool _closed = false;
+    };
+
+    //阶段统计
+    class PipelineStatistic
+    {
+    public:
+        std::string _name;
+        size_t _parallelism = 0;
+        uint64_t _items = 0;         //已处理的数据个数
+        uint64_t _batches = 0;       //已处理的批次数
+        size_t _queueSize = 0;       //输入队列中排队的批次数
+        size_t _queueItems = 0;      //输入队列中排队的数据个数
+        size_t _queueCapacity = 0;   //输入队列容量(批次)
+        uint64_t _elapsedMs = 0;     //开始运行至今的毫秒数
+        uint64_t _busyUs = 0;        //所有工作线程累计处理耗时
+
+        //每秒处理的数据个数
+        double throughput() const
+        {
+            return _elapsedMs ? _items * 1000.0 / _elapsedMs : 0;
+        }
+
+        //输入队列占用率，持续接近1说明本阶段是瓶颈
+        double occupancy() const
+        {
+            return _queueCapacity ? (double)_queueSize / _queueCapacity : 0;
+        }
+    };
+
+    class PipelineStageBase
+    {
+    public:
+        typedef std::shared_ptr<PipelineStageBase> Ptr;
+        virtual ~PipelineStageBase() {}
+        virtual void start() = 0;
+        virtual void join() = 0;
+        virtual PipelineStatistic getStatistic() = 0;
+    };
+
+    /**
+     * 流水线的一个阶段：parallelism个工作线程从输入队列取批次，经_fn处理后交给_consumer
+     * 有序阶段通过重排缓冲按输入序号依次交付；最后一个工作线程退出时调用_onFinish
+     */
+    template <typename In, typename Out>
+    class PipelineStage : public PipelineStageBase
+    {
+    public:
+        typedef std::function<void(std::vector<In> &in, std::vector<Out> &out)> Function;
+        typedef std::function<void(std::vector<Out> &out)> Consumer;
+
+        PipelineStage(const std::string &name, size_t parallelism, PipelineOrdering ordering, Function fn,
+                      const typename PipelineQueue<In>::Ptr &input, Consumer consumer, std::function<void()> onFinish)
+            : _name(name), _parallelism(parallelism ? parallelism : 1), _ordering(ordering), _fn(std::move(fn)),
+              _input(input), _consumer(std::move(consumer)), _onFinish(std::move(onFinish)),
+              _pool(_parallelism, ThreadPool::PRIORITY_HIGHEST, false)
+        {
+        }
+
+        ~PipelineStage() override
+        {
+            _input->close();
+            join();
+        }
+
+        void start() override
+        {
+            _startTime = getCurrentMillisecond();
+            _started = true;
+            _running = _parallelism;
+            _pool.start();
+            for (size_t i = 0; i < _parallelism; ++i)
+            {
+                _pool.async([this]() {
+                    work();
+                });
+            }
+        }
+
+        void join() override
+        {
+            std::unique_lock<std::mutex> lck(_mtxFinish);
+            while (_running)
+            {
+                _finished.wait(lck);
+            }
+        }
+
+        PipelineStatistic getStatistic() override
+        {
+            PipelineStatistic ret;
+            ret._name = _name;
+            ret._parallelism = _parallelism;
+            ret._items = _items.load();
+            ret._batches = _batches.load();
+            ret._queueSize = _input->size();
+            ret._queueItems = _input->itemCount();
+            ret._queueCapacity = _input->capacity();
+            ret._elapsedMs = _started ? getCurrentMillisecond() - _startTime : 0;
+            ret._busyUs = _busyUs.load();
+            return ret;
+        }
+
+    private:
+        void work()
+        {
+            typename PipelineQueue<In>::Batch batch;
+            while (_input->pop(batch))
+            {
+                std::vector<Out> out;
+                auto count = batch._items.size();
+                auto begin = getCurrentMicrosecond();
+                try
+                {
+                    _fn(batch._items, out);
+                }
+                catch (std::exception &ex)
+                {
+                    std::cout << "Pipeline阶段" << _name << "处理捕获到异常:" << ex.what() << std::endl;
+                }
+                _busyUs += getCurrentMicrosecond() - begin;
+                _items += count;
+                ++_batches;
+                deliver(batch._seq, out);
+            }
+
+            std::lock_guard<std::mutex> lck(_mtxFinish);
+            if (--_running == 0)
+            {
+                if (_onFinish)
+                {
+                    _onFinish();
+                }
+                _finished.notify_all();
+            }
+        }
+
+        void deliver(uint64_t seq, std::vector<Out> &out)
+        {
+            if (_ordering == PIPELINE_UNORDERED)
+            {
+                consume(out);
+                return;
+            }
+
+            //在锁内按序号交付，保证下游看到的顺序与输入一致；下游满时在此阻塞，反压传递给本阶段的其他线程
+            std::lock_guard<std::mutex> lck(_mtxReorder);
+            if (seq != _nextSeq)
+            {
+                _reorder.emplace(seq, std::move(out));
+                return;
+            }
+            consume(out);
+            ++_nextSeq;
+            for (auto it = _reorder.begin(); it != _reorder.end() && it->first == _nextSeq; it = _reorder.erase(it))
+            {
+                consume(it->second);
+                ++_nextSeq;
+            }
+        }
+
+        void consume(std::vector<Out> &out)
+        {
+            try
+            {
+                _consumer(out);
+            }
+            catch (std::exception &ex)
+            {
+                std::cout << "Pipeline阶段" << _name << "交付捕获到异常:" << ex.what() << std::endl;
+            }
+        }
+
+    private:
+        std::string _name;
+        size_t _parallelism;
+        PipelineOrdering _ordering;
+        Function _fn;
+        typename PipelineQueue<In>::Ptr _input;
+        Consumer _consumer;
+        std::function<void()> _onFinish;
+
+        std::mutex _mtxReorder;
+        uint64_t _nextSeq = 0;
+        std::map<uint64_t, std::vector<Out> > _reorder;
+
+        std::mutex _mtxFinish;
+        std::condition_variable _finished;
+        size_t _running = 0;
+
+        uint64_t _startTime = 0;
+        std::atomic<bool> _started{false};
+        std::atomic<uint64_t> _items{0};
+        std::atomic<uint64_t> _batches{0};
+        std::atomic<uint64_t> _busyUs{0};
+
+        //最后析构，先等所有工作线程退出
+        ThreadPool _pool;
+    };
+
+    /**
+     * 多阶段流水线，每个阶段拥有独立的线程池，阶段之间通过有界队列按批传递数据
+     * 用法：
+     *   auto pipeline = Pipeline<std::string>::create(64, 16);
+     *   pipeline->map<Record>("decode", 4, PIPELINE_UNORDERED, decode)
+     *           .map<Record>("transform", 2, PIPELINE_ORDERED, transform)
+     *           .sink("write", 1, PIPELINE_ORDERED, write);
+     *   pipeline->push(line); ... pipeline->wait();
+     */
+    template <typename Source>
+    class Pipeline
+    {
+    public:
+        typedef std::shared_ptr<Pipeline> Ptr;
+
+        template <typename Tail>
+        class Builder
+        {
+        public:
+            Builder(Pipeline *pipeline, const typename PipelineQueue<Tail>::Ptr &tail) : _pipeline(pipeline), _tail(tail) {}
+
+            /**
+             * 添加按批处理的阶段
+             * @param name 阶段名称，用于统计
+             * @param parallelism 并行线程数
+             * @param ordering 是否按输入顺序输出
+             * @param fn 处理函数，将一批输入转换为若干输出，会被多个线程并发调用
+             */
+            template <typename Out>
+            Builder<Out> stage(const std::string &name, size_t parallelism, PipelineOrdering ordering,
+                               typename PipelineStage<Tail, Out>::Function fn)
+            {
+                auto output = std::make_shared<PipelineQueue<Out> >(_pipeline->_queueCapacity);
+                auto stage = std::make_shared<PipelineStage<Tail, Out> >(name, parallelism, ordering, std::move(fn), _tail,
+                    [output](std::vector<Out> &out) {
+                        if (!out.empty())
+                        {
+                            output->push(std::move(out));
+                        }
+                    },
+                    [output]() {
+                        output->close();
+                    });
+                _pipeline->_stages.emplace_back(stage);
+                return Builder<Out>(_pipeline, output);
+            }
+
+            //添加逐个处理的阶段
+            template <typename Out>
+            Builder<Out> map(const std::string &name, size_t parallelism, PipelineOrdering ordering, std::function<Out(Tail &)> fn)
+            {
+                return stage<Out>(name, parallelism, ordering, [fn](std::vector<Tail> &in, std::vector<Out> &out) {
+                    out.reserve(in.size());
+                    for (auto &item : in)
+                    {
+                        out.emplace_back(fn(item));
+                    }
+                });
+            }
+
+            /**
+             * 添加最后一个阶段并启动流水线
+             * @param fn 消费函数；有序时按输入顺序串行调用，无序时被多个线程并发调用
+             */
+            void sink(const std::string &name, size_t parallelism, PipelineOrdering ordering, std::function<void(std::vector<Tail> &)> fn)
+            {
+                auto pipeline = _pipeline;
+                auto stage = std::make_shared<PipelineStage<Tail, Tail> >(name, parallelism, ordering,
+                    [](std::vector<Tail> &in, std::vector<Tail> &out) {
+                        out.swap(in);
+                    },
+                    _tail, std::move(fn),
+                    [pipeline]() {
+                        pipeline->_done.post();
+                    });
+                _pipeline->_stages.emplace_back(stage);
+                _pipeline->start();
+            }
+
+        private:
+            Pipeline *_pipeline;
+            typename PipelineQueue<Tail>::Ptr _tail;
+        };
+
+        /**
+         * @param batchSize push时攒够多少个数据组成一批
+         * @param queueCapacity 每个阶段输入队列最多缓存的批次数
+         */
+        static Ptr create(size_t batchSize = 64, size_t queueCapacity = 16)
+        {
+            return Ptr(new Pipeline(batchSize, queueCapacity));
+        }
+
+        ~Pipeline()
+        {
+            close();
+            //按上游到下游的顺序析构，每个阶段析构时等待自身工作线程退出
+            _stages.clear();
+        }
+
+        //从数据源开始描述流水线
+        Builder<Source> source()
+        {
+            return Builder<Source>(this, _head);
+        }
+
+        //便于链式调用，等同于source().map
+        template <typename Out>
+        Builder<Out> map(const std::string &name, size_t parallelism, PipelineOrdering ordering, std::function<Out(Source &)> fn)
+        {
+            return source().template map<Out>(name, parallelism, ordering, std::move(fn));
+        }
+
+        template <typename Out>
+        Builder<Out> stage(const std::string &name, size_t parallelism, PipelineOrdering ordering,
+                           typename PipelineStage<Source, Out>::Function fn)
+        {
+            return source().template stage<Out>(name, parallelism, ordering, std::move(fn));
+        }
+
+        //攒够batchSize个后整批入队，第一阶段输入队列满时阻塞；已关闭时返回false
+        bool push(Source item)
+        {
+            std::vector<Source> batch;
+            {
+                std::lock_guard<std::mutex> lck(_mtxPending);
+                _pending.emplace_back(std::move(item));
+                if (_pending.size() < _batchSize)
+                {
+                    return true;
+                }
+                batch.swap(_pending);
+                _pending.reserve(_batchSize);
+            }
+            return _head->push(std::move(batch));
+        }
+
+        //整批入队，第一阶段输入队列满时阻塞
+        bool pushBatch(std::vector<Source> batch)
+        {
+            if (batch.empty())
+            {
+                return true;
+            }
+            return _head->push(std::move(batch));
+        }
+
+        //将未攒满的数据入队
+        void flush()
+        {
+            std::vector<Source> batch;
+            {
+                std::lock_guard<std::mutex> lck(_mtxPending);
+                batch.swap(_pending);
+            }
+            pushBatch(std::move(batch));
+        }
+
+        //不再接收新数据，已入队的数据将继续流经所有阶段
+        void close()
+        {
+            flush();
+            _head->close();
+        }
+
+        //关闭流水线并等待所有数据处理完毕，未攒满的数据也会被处理
+        void wait()
+        {
+            //未关闭时第一阶段永远等待新数据，先关闭避免一直阻塞
+            close();
+            if (_started && !_waited.exchange(true))
+            {
+                _done.wait();
+            }
+        }
+
+        std::vector<PipelineStatistic> getStatistic()
+        {
+            std::vector<PipelineStatistic> ret;
+            for (auto &stage : _stages)
+            {
+                ret.emplace_back(stage->getStatistic());
+            }
+            return ret;
+        }
+
+    private:
+        Pipeline(size_t batchSize, size_t queueCapacity)
+            : _batchSize(batchSize ? batchSize : 1), _queueCapacity(queueCapacity),
+              _head(std::make_shared<PipelineQueue<Source> >(queueCapacity))
+        {
+            _pending.reserve(_batchSize);
+        }
+
+        void start()
+        {
+            for (auto &stage : _stages)
+            {
+                stage->start();
+            }
+            _started = true;
+        }
+
+    private:
+        size_t _batchSize;
+        size_t _queueCapacity;
+        typename PipelineQueue<Source>::Ptr _head;
+
+        std::mutex _mtxPending;
+        std::vector<Source> _pending;
+
+        std::vector<PipelineStageBase::Ptr> _stages;
+        Semaphore _done;
+        bool _started = false;
+        std::atomic<bool> _waited{false};
+    };
+}
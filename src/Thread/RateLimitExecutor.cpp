@@ -0,0 +1,212 @@
+#include "RateLimitExecutor.h"
+#include <algorithm>
+
+namespace JCToolKit
+{
+    void TokenBucket::setRate(double rate, double burst)
+    {
+        _rate = rate;
+        _burst = burst > 0 ? burst : std::max(rate, 1.0);
+        _tokens = _burst;
+        _lastTime = getCurrentMicrosecond();
+    }
+
+    void TokenBucket::refill(uint64_t nowUs)
+    {
+        if (nowUs <= _lastTime)
+        {
+            return;
+        }
+        _tokens = std::min(_burst, _tokens + (nowUs - _lastTime) * _rate / 1000000);
+        _lastTime = nowUs;
+    }
+
+    bool TokenBucket::available(double n, uint64_t nowUs)
+    {
+        if (_rate <= 0)
+        {
+            return true;
+        }
+        refill(nowUs);
+        return _tokens >= std::min(n, _burst);
+    }
+
+    void TokenBucket::consume(double n)
+    {
+        if (_rate > 0)
+        {
+            _tokens -= n;
+        }
+    }
+
+    uint64_t TokenBucket::waitTime(double n, uint64_t nowUs)
+    {
+        if (available(n, nowUs))
+        {
+            return 0;
+        }
+        return (uint64_t)((std::min(n, _burst) - _tokens) * 1000000 / _rate) + 1;
+    }
+
+    RateLimitExecutor::RateLimitExecutor(const OperationExecutor::Ptr &executor, const EventPoller::Ptr &poller)
+    {
+        _executor = executor;
+        _poller = poller ? poller : EventPollerPool::Instance().getPoller();
+    }
+
+    void RateLimitExecutor::setTaskRate(double tasksPerSecond, double burst)
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        _taskBucket.setRate(tasksPerSecond, burst);
+    }
+
+    void RateLimitExecutor::setCostRate(double costPerSecond, double burst)
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        _costBucket.setRate(costPerSecond, burst);
+    }
+
+    Operation::Ptr RateLimitExecutor::async(OperationFunction operation, bool maySync)
+    {
+        return asyncCost(std::move(operation), 1, maySync);
+    }
+
+    Operation::Ptr RateLimitExecutor::asyncCost(OperationFunction operation, double cost, bool maySync)
+    {
+        auto op = Operation::create(std::move(operation));
+        bool throttled = false;
+        uint64_t delayMs = 0;
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            auto now = getCurrentMicrosecond();
+            //已有任务排队时必须排在其后，保证先进先出
+            if (!_pending.empty() || !tryConsume(cost, now))
+            {
+                throttled = true;
+                _pending.emplace_back(op, cost, now, maySync);
+                ++_throttledCount;
+                if (!_timerStarted)
+                {
+                    _timerStarted = true;
+                    delayMs = nextDelayMs(now);
+                }
+            }
+        }
+
+        if (!throttled)
+        {
+            forward(op, maySync);
+        }
+        else if (delayMs)
+        {
+            //释放定时器为所有排队任务服务，不能随某个任务的CancelToken取消
+            CancelToken::Scope scope(nullptr);
+            std::weak_ptr<RateLimitExecutor> weakSelf = shared_from_this();
+            _poller->startDelayOperation(delayMs, [weakSelf]() -> uint64_t {
+                auto strongSelf = weakSelf.lock();
+                if (!strongSelf)
+                {
+                    return 0;
+                }
+                return strongSelf->release();
+            });
+        }
+        return op;
+    }
+
+    bool RateLimitExecutor::tryConsume(double cost, uint64_t nowUs)
+    {
+        if (!_taskBucket.available(1, nowUs) || !_costBucket.available(cost, nowUs))
+        {
+            return false;
+        }
+        _taskBucket.consume(1);
+        _costBucket.consume(cost);
+        return true;
+    }
+
+    uint64_t RateLimitExecutor::nextDelayMs(uint64_t nowUs)
+    {
+        auto &item = _pending.front();
+        auto waitUs = std::max(_taskBucket.waitTime(1, nowUs), _costBucket.waitTime(item._cost, nowUs));
+        //延时任务精度为毫秒，至少等待1毫秒
+        return std::max<uint64_t>(1, (waitUs + 999) / 1000);
+    }
+
+    uint64_t RateLimitExecutor::release()
+    {
+        List<PendingItem> ready;
+        uint64_t nextDelay = 0;
+        {
+            std::lock_guard<std::mutex> lck(_mtx);
+            auto now = getCurrentMicrosecond();
+            while (!_pending.empty())
+            {
+                auto &item = _pending.front();
+                if (!tryConsume(item._cost, now))
+                {
+                    break;
+                }
+                _lastDelay = now - item._time;
+                _maxDelay = std::max(_maxDelay, _lastDelay);
+                _totalDelay += _lastDelay;
+                ++_releasedCount;
+                ready.emplace_back(std::move(item));
+                _pending.pop_front();
+            }
+
+            if (_pending.empty())
+            {
+                _timerStarted = false;
+            }
+            else
+            {
+                nextDelay = nextDelayMs(now);
+            }
+        }
+
+        ready.for_each([&](PendingItem &item) {
+            forward(item._op, item._maySync);
+        });
+        return nextDelay;
+    }
+
+    void RateLimitExecutor::forward(const Operation::Ptr &op, bool maySync)
+    {
+        //op自身已绑定CancelToken
+        CancelToken::Scope scope(nullptr);
+        _executor->async([op]() {
+            (*op)();
+        }, maySync);
+    }
+
+    size_t RateLimitExecutor::pendingSize()
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _pending.size();
+    }
+
+    uint64_t RateLimitExecutor::throttledCount()
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _throttledCount;
+    }
+
+    uint64_t RateLimitExecutor::lastThrottleDelay()
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _lastDelay;
+    }
+
+    uint64_t RateLimitExecutor::maxThrottleDelay()
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _maxDelay;
+    }
+
+    uint64_t RateLimitExecutor::averageThrottleDelay()
+    {
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _releasedCount ? _totalDelay / _releasedCount : 0;
+    }
+}
@@ -0,0 +1,114 @@
+#pragma once
+
+#include <mutex>
+#include <memory>
+#include "OperationExecutor.h"
+#include "Poller/EventPoller.h"
+#include "Util/List.h"
+
+namespace JCToolKit
+{
+    //令牌桶，rate为0时不限速
+    class TokenBucket
+    {
+    public:
+        TokenBucket() {}
+        ~TokenBucket() {}
+
+        //rate:每秒产生的令牌数 burst:桶容量，为0时取一秒的令牌数
+        void setRate(double rate, double burst = 0);
+
+        //now时刻是否有足够的令牌消耗n个，n超过桶容量时桶满即可消耗(此后令牌为负)
+        bool available(double n, uint64_t nowUs);
+
+        void consume(double n);
+
+        //距离可以消耗n个令牌还需等待的微秒数
+        uint64_t waitTime(double n, uint64_t nowUs);
+
+    private:
+        void refill(uint64_t nowUs);
+
+    private:
+        double _rate = 0;
+        double _burst = 0;
+        double _tokens = 0;
+        uint64_t _lastTime = 0;
+    };
+
+    /**
+     * 限速执行器，可包装任意OperationExecutor
+     * 超出速率的任务在内部排队，由EventPoller的延时任务按令牌桶速率释放
+     */
+    class RateLimitExecutor : public OperationExecutorProtocol, public std::enable_shared_from_this<RateLimitExecutor>
+    {
+    public:
+        typedef std::shared_ptr<RateLimitExecutor> Ptr;
+
+        /**
+         * @param executor 实际执行任务的执行器
+         * @param poller 负责定时释放排队任务的EventPoller，为空时从EventPollerPool获取
+         */
+        RateLimitExecutor(const OperationExecutor::Ptr &executor, const EventPoller::Ptr &poller = nullptr);
+        ~RateLimitExecutor() {}
+
+        //每秒最多执行的任务数，0为不限制
+        void setTaskRate(double tasksPerSecond, double burst = 0);
+
+        //每秒最多消耗的代价单位，0为不限制
+        void setCostRate(double costPerSecond, double burst = 0);
+
+        Operation::Ptr async(OperationFunction operation, bool maySync = true) override;
+
+        //提交一个代价为cost的任务
+        Operation::Ptr asyncCost(OperationFunction operation, double cost, bool maySync = true);
+
+        //排队中的任务个数
+        size_t pendingSize();
+
+        //因限速而排队过的任务个数
+        uint64_t throttledCount();
+
+        //最近一次、最大以及平均的限速排队时长，单位微秒
+        uint64_t lastThrottleDelay();
+        uint64_t maxThrottleDelay();
+        uint64_t averageThrottleDelay();
+
+    private:
+        class PendingItem
+        {
+        public:
+            PendingItem(Operation::Ptr op, double cost, uint64_t time, bool maySync) : _op(std::move(op)), _cost(cost), _time(time), _maySync(maySync) {}
+
+        public:
+            Operation::Ptr _op;
+            double _cost;
+            uint64_t _time;
+            bool _maySync;
+        };
+
+        bool tryConsume(double cost, uint64_t nowUs);
+
+        uint64_t nextDelayMs(uint64_t nowUs);
+
+        uint64_t release();
+
+        void forward(const Operation::Ptr &op, bool maySync);
+
+    private:
+        OperationExecutor::Ptr _executor;
+        EventPoller::Ptr _poller;
+
+        std::mutex _mtx;
+        TokenBucket _taskBucket;
+        TokenBucket _costBucket;
+        List<PendingItem> _pending;
+        bool _timerStarted = false;
+
+        uint64_t _throttledCount = 0;
+        uint64_t _lastDelay = 0;
+        uint64_t _maxDelay = 0;
+        uint64_t _totalDelay = 0;
+        uint64_t _releasedCount = 0;
+    };
+}
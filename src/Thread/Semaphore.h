@@ -35,8 +35,13 @@ namespace JCToolKit {
             --_count;
         }
 
+        //当前计数，无锁读取，仅作为是否有待处理信号的提示
+        size_t count() const {
+            return _count.load(std::memory_order_relaxed);
+        }
+
     private:
-        size_t _count;
+        std::atomic<size_t> _count;
         std::mutex _mutex;
         std::condition_variable_any _condition;
     };
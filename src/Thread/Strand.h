@@ -0,0 +1,192 @@
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <iostream>
+#include <algorithm>
+#include <functional>
+#include "OperationExecutor.h"
+
+namespace JCToolKit
+{
+    //串行执行器：投递到同一个Strand的任务按顺序执行且不会并发，
+    //但可以由底层执行器的任意线程执行；队列为空时不占用任何线程
+    class Strand : public OperationExecutorProtocol, public std::enable_shared_from_this<Strand>
+    {
+    public:
+        typedef std::shared_ptr<Strand> Ptr;
+
+        //maxBatch:一次调度最多连续执行的任务个数，执行完后让出工作线程
+        Strand(const OperationExecutor::Ptr &executor, size_t maxBatch = 64) : _executor(executor), _maxBatch(maxBatch)
+        {
+            _head = new Node;
+            _tail = _head;
+        }
+
+        ~Strand()
+        {
+            while (_head)
+            {
+                auto next = _head->_next.load();
+                delete _head;
+                _head = next;
+            }
+        }
+
+        Operation::Ptr async(OperationFunction operation, bool maySync = true) override
+        {
+            if (maySync && isCurrentThread())
+            {
+                operation();
+                return nullptr;
+            }
+            auto op = Operation::create(std::move(operation));
+            push(op);
+            return op;
+        }
+
+        //是否正在本Strand的任务中
+        bool isCurrentThread() const
+        {
+            return current() == this;
+        }
+
+        //尚未执行完的任务个数
+        size_t size() const
+        {
+            return _pending.load(std::memory_order_acquire);
+        }
+
+    private:
+        class Node
+        {
+        public:
+            Operation::Ptr _op;
+            std::atomic<Node *> _next{nullptr};
+        };
+
+        static const Strand *&current()
+        {
+            static thread_local const Strand *s_current = nullptr;
+            return s_current;
+        }
+
+        //多生产者无锁入队，计数从0变为1的生产者负责调度
+        void push(Operation::Ptr op)
+        {
+            auto node = new Node;
+            node->_op = std::move(op);
+            auto prev = _tail.exchange(node, std::memory_order_acq_rel);
+            prev->_next.store(node, std::memory_order_release);
+            if (_pending.fetch_add(1, std::memory_order_acq_rel) == 0)
+            {
+                schedule();
+            }
+        }
+
+        //单消费者出队，同一时刻只有一个run在执行
+        bool pop(Operation::Ptr &op)
+        {
+            auto next = _head->_next.load(std::memory_order_acquire);
+            if (!next)
+            {
+                return false;
+            }
+            delete _head;
+            _head = next;
+            op = std::move(next->_op);
+            return true;
+        }
+
+        void schedule()
+        {
+            //调度任务属于Strand本身，不能随某个任务的CancelToken取消
+            CancelToken::Scope scope(nullptr);
+            auto self = shared_from_this();
+            _executor->async([self]() {
+                self->run();
+            }, false);
+        }
+
+        void run()
+        {
+            auto last = current();
+            current() = this;
+
+            auto count = std::min(_pending.load(std::memory_order_acquire), _maxBatch);
+            Operation::Ptr op;
+            for (size_t i = 0; i < count; ++i)
+            {
+                while (!pop(op))
+                {
+                    //生产者已计数但尚未完成链接，极短暂
+                    std::this_thread::yield();
+                }
+                try
+                {
+                    (*op)();
+                }
+                catch (std::exception &ex)
+                {
+                    std::cout << "Strand: catch exception" << ex.what() << std::endl;
+                }
+                op = nullptr;
+            }
+
+            current() = last;
+            if (_pending.fetch_sub(count, std::memory_order_acq_rel) != count)
+            {
+                //还有剩余任务，重新排队以免长期占用工作线程
+                schedule();
+            }
+        }
+
+    private:
+        OperationExecutor::Ptr _executor;
+        size_t _maxBatch;
+        Node *_head;
+        std::atomic<Node *> _tail;
+        std::atomic<size_t> _pending{0};
+    };
+
+    //按key分区的串行执行器：相同key的任务顺序且串行执行，不同key可在所有工作线程上并行
+    template <typename Key, typename Hash = std::hash<Key> >
+    class KeyedExecutor
+    {
+    public:
+        typedef std::shared_ptr<KeyedExecutor> Ptr;
+
+        //partitions:分区个数，越大则不同key落在同一分区的概率越低
+        KeyedExecutor(const OperationExecutor::Ptr &executor, size_t partitions = 64, size_t maxBatch = 64)
+        {
+            if (partitions == 0)
+            {
+                partitions = 1;
+            }
+            _strands.reserve(partitions);
+            for (size_t i = 0; i < partitions; ++i)
+            {
+                _strands.emplace_back(std::make_shared<Strand>(executor, maxBatch));
+            }
+        }
+
+        ~KeyedExecutor() {}
+
+        Operation::Ptr async(const Key &key, OperationFunction operation, bool maySync = true)
+        {
+            return getStrand(key)->async(std::move(operation), maySync);
+        }
+
+        const Strand::Ptr &getStrand(const Key &key)
+        {
+            return _strands[_hash(key) % _strands.size()];
+        }
+
+    private:
+        Hash _hash;
+        std::vector<Strand::Ptr> _strands;
+    };
+
+}
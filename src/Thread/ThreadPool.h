@@ -1,9 +1,11 @@
 #pragma once
 
 #include <vector>
+#include <atomic>
 #include "OperationExecutor.h"
 #include "ThreadGroup.h"
 #include "OperationQueue.h"
+#include "Util/CpuTopology.h"
 #include <iostream>
 
 namespace JCToolKit
@@ -20,6 +22,14 @@ namespace JCToolKit
             PRIORITY_HIGHEST
         };
 
+        //任务错过截止时间后的处理方式
+        enum DeadlinePolicy
+        {
+            DEADLINE_RUN = 0, //照常执行
+            DEADLINE_DROP,    //直接丢弃
+            DEADLINE_DEMOTE   //降级到普通任务队列末尾
+        };
+
         //num:线程池线程个数
         ThreadPool(size_t num = 1,
                    Priority priority = PRIORITY_HIGHEST,
@@ -46,10 +56,28 @@ namespace JCToolKit
             size_t total = _threadNum - _threadGroup.size();
             for (size_t i = 0; i < _threadNum; ++i)
             {
-                _threadGroup.createThread(std::bind(&ThreadPool::run, this));
+                _threadGroup.createThread(std::bind(&ThreadPool::run, this, i));
             }
         }
 
+        /**
+         * 设置工作线程空闲策略：队列为空时先自旋spinCount次(pause指令)，
+         * 再让出CPU yieldCount次，仍无任务才休眠等待；均为0时直接休眠
+         * 自旋可避免突发小任务每次都要唤醒线程，代价是空闲时占用CPU，可通过spinLoad()观察
+         */
+        void setIdleStrategy(uint32_t spinCount, uint32_t yieldCount = 0)
+        {
+            _spinCount = spinCount;
+            _yieldCount = yieldCount;
+        }
+
+        //设置工作线程绑核策略，需在start之前调用
+        void setPlacement(CpuPlacement placement, const std::vector<int> &cpuSet = std::vector<int>())
+        {
+            _placement = placement;
+            _cpuSet = cpuSet;
+        }
+
         Operation::Ptr async(OperationFunction operation, bool maySync = true)
         {
             if (maySync && _threadGroup.isThisThreadIn())
@@ -57,7 +85,7 @@ namespace JCToolKit
                 operation();
                 return nullptr;
             }
-            auto op = std::make_shared<Operation>(std::move(operation));
+            auto op = Operation::create(std::move(operation));
             _queue.push_back(op);
             return op;
         }
@@ -69,11 +97,69 @@ namespace JCToolKit
                 operation();
                 return nullptr;
             }
-            auto op = std::make_shared<Operation>(std::move(operation));
+            auto op = Operation::create(std::move(operation));
             _queue.push_front(op);
             return op;
         }
 
+        /**
+         * 按截止时间最早优先(EDF)调度任务，截止时间任务优先于普通任务执行，但每连续执行若干个后穿插一个普通任务，见setDeadlinePolicy
+         * @param operation 任务
+         * @param timeoutMs 距现在多少毫秒内应被执行
+         * @param maySync 当前线程属于该线程池时是否直接同步执行
+         */
+        Operation::Ptr asyncDeadline(OperationFunction operation, uint64_t timeoutMs, bool maySync = true)
+        {
+            if (maySync && _threadGroup.isThisThreadIn())
+            {
+                operation();
+                return nullptr;
+            }
+            auto op = Operation::create(std::move(operation));
+            _queue.push_deadline(op, getCurrentMicrosecond() + timeoutMs * 1000);
+            return op;
+        }
+
+        /**
+         * 设置错过截止时间的处理方式，可在运行期间修改
+         * @param policy 处理方式
+         * @param fifoInterval 每连续执行多少个截止时间任务后先执行一个普通任务(含降级的任务)，0为截止时间任务严格优先
+         */
+        void setDeadlinePolicy(DeadlinePolicy policy, size_t fifoInterval = 8)
+        {
+            _deadlinePolicy = policy;
+            _queue.set_fifo_interval(fifoInterval);
+        }
+
+        //错过截止时间的任务个数
+        uint64_t deadlineMissCount() const
+        {
+            return _deadlineMiss.load();
+        }
+
+        //因错过截止时间被丢弃的任务个数
+        uint64_t deadlineDropCount() const
+        {
+            return _deadlineDrop.load();
+        }
+
+        using OperationExecutorProtocol::asyncBatch;
+
+        std::vector<Operation::Ptr> asyncBatch(std::vector<OperationFunction> operations, bool maySync = true, bool contiguous = false) override
+        {
+            if (maySync && _threadGroup.isThisThreadIn())
+            {
+                for (auto &operation : operations)
+                {
+                    operation();
+                }
+                return std::vector<Operation::Ptr>();
+            }
+            auto ret = createOperations(operations, contiguous);
+            _queue.push_back_batch(ret.begin(), ret.end());
+            return ret;
+        }
+
         size_t size()
         {
             return _queue.size();
@@ -108,20 +194,69 @@ namespace JCToolKit
             return pthread_setschedparam(threadID, SCHED_OTHER, &params) == 0;
         }
 
+        //将线程绑定到cpus中的CPU上，cpus为空时解除绑定
+        static bool setAffinity(const std::vector<int> &cpus, std::thread::native_handle_type threadID = 0)
+        {
+#if defined(__linux__) || defined(__linux)
+            if (threadID == 0)
+            {
+                threadID = pthread_self();
+            }
+            cpu_set_t mask;
+            CPU_ZERO(&mask);
+            if (cpus.empty())
+            {
+                for (auto &info : CpuTopology::Instance().cpus())
+                {
+                    CPU_SET(info._cpu, &mask);
+                }
+            }
+            for (auto cpu : cpus)
+            {
+                CPU_SET(cpu, &mask);
+            }
+            return pthread_setaffinity_np(threadID, sizeof(mask), &mask) == 0;
+#else
+            return false;
+#endif
+        }
+
     private:
-        void run()
+        void run(size_t index)
         {
             ThreadPool::setPriority(_priority);
+            if (_placement != CPU_PLACEMENT_NONE)
+            {
+                ThreadPool::setAffinity(CpuTopology::Instance().placement(_placement, index, _cpuSet));
+            }
             Operation::Ptr op;
+            uint64_t deadline;
             while (true)
             {
-                startSleep();
-                if (!_queue.get_operation(op))
+                idle();
+                if (!_queue.get_operation(op, &deadline))
                 {
                     //空任务，退出线程
                     break;
                 }
                 wakeUp();
+                if (deadline != UINT64_MAX && deadline < getCurrentMicrosecond())
+                {
+                    ++_deadlineMiss;
+                    auto policy = _deadlinePolicy.load(std::memory_order_relaxed);
+                    if (policy == DEADLINE_DROP)
+                    {
+                        ++_deadlineDrop;
+                        op = nullptr;
+                        continue;
+                    }
+                    if (policy == DEADLINE_DEMOTE)
+                    {
+                        _queue.push_back(std::move(op));
+                        op = nullptr;
+                        continue;
+                    }
+                }
                 try
                 {
                     (*op)();
@@ -134,6 +269,30 @@ namespace JCToolKit
             }
         }
 
+        void idle()
+        {
+            uint32_t spinCount = _spinCount;
+            uint32_t yieldCount = _yieldCount;
+            if ((spinCount || yieldCount) && !_queue.ready())
+            {
+                startSpin();
+                for (uint32_t i = 0; i < spinCount && !_queue.ready(); ++i)
+                {
+                    cpuRelax();
+                }
+                for (uint32_t i = 0; i < yieldCount && !_queue.ready(); ++i)
+                {
+                    std::this_thread::yield();
+                }
+                if (_queue.ready())
+                {
+                    //自旋期间等到了任务，无需休眠
+                    return;
+                }
+            }
+            startSleep();
+        }
+
         void wait()
         {
             _threadGroup.joinAll();
@@ -146,9 +305,16 @@ namespace JCToolKit
 
     private:
         size_t _threadNum;
-        OperationQueue<Operation::Ptr> _queue;
+        OperationQueue<Operation::Ptr, OperationList> _queue;
         ThreadGroup _threadGroup;
         Priority _priority;
+        std::atomic<uint32_t> _spinCount{0};
+        std::atomic<uint32_t> _yieldCount{0};
+        CpuPlacement _placement = CPU_PLACEMENT_NONE;
+        std::vector<int> _cpuSet;
+        std::atomic<DeadlinePolicy> _deadlinePolicy{DEADLINE_RUN};
+        std::atomic<uint64_t> _deadlineMiss{0};
+        std::atomic<uint64_t> _deadlineDrop{0};
     };
 
 }
\ No newline at end of file
@@ -4,12 +4,14 @@
 namespace JCToolKit
 {
     int WorkThreadPool::s_pool_size = 0;
+    CpuPlacement WorkThreadPool::s_placement = CPU_PLACEMENT_NONE;
+    std::vector<int> WorkThreadPool::s_cpu_set;
 
     INSTANCE_IMP(WorkThreadPool);
 
     EventPoller::Ptr WorkThreadPool::getFirstPoller()
     {
-        return std::dynamic_pointer_cast<EventPoller>(_executors.front());
+        return std::dynamic_pointer_cast<EventPoller>(getExecutors()->front());
     }
 
     EventPoller::Ptr WorkThreadPool::getPoller()
@@ -20,9 +22,14 @@ namespace JCToolKit
     WorkThreadPool::WorkThreadPool()
     {
         auto size = s_pool_size > 0 ? s_pool_size : std::thread::hardware_concurrency();
-        createExecutors([]() {
+        size_t index = 0;
+        createExecutors([&]() {
             EventPoller::Ptr ret(new EventPoller(ThreadPool::PRIORITY_LOWEST));
             ret->runLoop(false, false);
+            if (s_placement != CPU_PLACEMENT_NONE)
+            {
+                ret->setAffinity(CpuTopology::Instance().placement(s_placement, index++, s_cpu_set));
+            }
             return ret;
         },
                         size);
@@ -32,4 +39,10 @@ namespace JCToolKit
     {
         s_pool_size = size;
     }
+
+    void WorkThreadPool::setPlacement(CpuPlacement placement, const std::vector<int> &cpuSet)
+    {
+        s_placement = placement;
+        s_cpu_set = cpuSet;
+    }
 }
@@ -16,6 +16,9 @@ namespace JCToolKit
 
         static void setPoolSize(int size = 0);
 
+        //设置工作线程绑核策略，需在首次调用Instance之前设置
+        static void setPlacement(CpuPlacement placement, const std::vector<int> &cpuSet = std::vector<int>());
+
         EventPoller::Ptr getFirstPoller();
 
         EventPoller::Ptr getPoller();
@@ -25,5 +28,7 @@ namespace JCToolKit
 
     private:
         static int s_pool_size;
+        static CpuPlacement s_placement;
+        static std::vector<int> s_cpu_set;
     };
 }
\ No newline at end of file
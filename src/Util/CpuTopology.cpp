@@ -0,0 +1,238 @@
+#include "CpuTopology.h"
+#include "Utilities.h"
+#include <map>
+#include <thread>
+#include <fstream>
+#include <algorithm>
+#include <dirent.h>
+#include <stdlib.h>
+
+namespace JCToolKit
+{
+    static bool readFile(const std::string &path, std::string &content)
+    {
+        std::ifstream file(path);
+        if (!file)
+        {
+            return false;
+        }
+        std::getline(file, content);
+        return true;
+    }
+
+    static int readInt(const std::string &path, int defaultValue)
+    {
+        std::string content;
+        if (!readFile(path, content) || content.empty())
+        {
+            return defaultValue;
+        }
+        return atoi(content.data());
+    }
+
+    std::vector<int> CpuTopology::parseCpuList(const std::string &str)
+    {
+        std::vector<int> ret;
+        std::stringstream ss(str);
+        std::string range;
+        while (std::getline(ss, range, ','))
+        {
+            if (range.empty())
+            {
+                continue;
+            }
+            auto pos = range.find('-');
+            int first = atoi(range.data());
+            int last = pos == std::string::npos ? first : atoi(range.data() + pos + 1);
+            for (int cpu = first; cpu <= last; ++cpu)
+            {
+                ret.emplace_back(cpu);
+            }
+        }
+        return ret;
+    }
+
+    INSTANCE_IMP(CpuTopology);
+
+    CpuTopology::CpuTopology()
+    {
+        const std::string cpuRoot = "/sys/devices/system/cpu/";
+        std::string online;
+        std::vector<int> cpuList;
+        if (readFile(cpuRoot + "online", online))
+        {
+            cpuList = parseCpuList(online);
+        }
+        if (cpuList.empty())
+        {
+            for (int cpu = 0; cpu < (int)std::thread::hardware_concurrency(); ++cpu)
+            {
+                cpuList.emplace_back(cpu);
+            }
+        }
+
+        std::map<int, int> nodeOfCpu;
+        if (auto dir = opendir("/sys/devices/system/node/"))
+        {
+            while (auto entry = readdir(dir))
+            {
+                int node;
+                if (sscanf(entry->d_name, "node%d", &node) != 1)
+                {
+                    continue;
+                }
+                std::string list;
+                if (readFile(std::string("/sys/devices/system/node/") + entry->d_name + "/cpulist", list))
+                {
+                    for (auto cpu : parseCpuList(list))
+                    {
+                        nodeOfCpu[cpu] = node;
+                    }
+                }
+            }
+            closedir(dir);
+        }
+
+        //(package, core_id)唯一确定一个物理核
+        std::map<std::pair<int, int>, int> coreIndex;
+        std::vector<CpuInfo> cpus;
+        for (auto cpu : cpuList)
+        {
+            auto prefix = cpuRoot + "cpu" + std::to_string(cpu) + "/";
+            CpuInfo info;
+            info._cpu = cpu;
+            info._package = readInt(prefix + "topology/physical_package_id", 0);
+            info._node = nodeOfCpu.count(cpu) ? nodeOfCpu[cpu] : 0;
+
+            auto key = std::make_pair(info._package, readInt(prefix + "topology/core_id", cpu));
+            auto it = coreIndex.find(key);
+            if (it == coreIndex.end())
+            {
+                it = coreIndex.emplace(key, (int)coreIndex.size()).first;
+            }
+            info._core = it->second;
+
+            for (int index = 0;; ++index)
+            {
+                auto cache = prefix + "cache/index" + std::to_string(index) + "/";
+                int level = readInt(cache + "level", -1);
+                if (level == -1)
+                {
+                    break;
+                }
+                std::string shared;
+                if (level == 3 && readFile(cache + "shared_cpu_list", shared))
+                {
+                    auto list = parseCpuList(shared);
+                    if (!list.empty())
+                    {
+                        info._l3 = list.front();
+                    }
+                }
+            }
+            cpus.emplace_back(info);
+        }
+        load(cpus);
+    }
+
+    CpuTopology::CpuTopology(const std::vector<CpuInfo> &cpus)
+    {
+        load(cpus);
+    }
+
+    void CpuTopology::load(const std::vector<CpuInfo> &cpus)
+    {
+        std::map<int, int> coreIndex;
+        for (auto info : cpus)
+        {
+            auto it = coreIndex.find(info._core);
+            if (it == coreIndex.end())
+            {
+                it = coreIndex.emplace(info._core, (int)_cores.size()).first;
+                _cores.emplace_back();
+            }
+            info._core = it->second;
+            _cores[info._core].emplace_back(info._cpu);
+            _cpus.emplace_back(info);
+        }
+    }
+
+    std::vector<int> CpuTopology::physicalCores() const
+    {
+        std::vector<int> ret;
+        for (auto &core : _cores)
+        {
+            ret.emplace_back(core.front());
+        }
+        return ret;
+    }
+
+    std::vector<int> CpuTopology::siblingCpus() const
+    {
+        std::vector<int> ret;
+        for (auto &core : _cores)
+        {
+            ret.emplace_back(core.size() > 1 ? core[1] : core.front());
+        }
+        return ret;
+    }
+
+    std::vector<int> CpuTopology::cpusOfNode(int node) const
+    {
+        std::vector<int> ret;
+        for (auto &info : _cpus)
+        {
+            if (info._node == node)
+            {
+                ret.emplace_back(info._cpu);
+            }
+        }
+        return ret;
+    }
+
+    std::vector<int> CpuTopology::cpusSharingL3(int cpu) const
+    {
+        std::vector<int> ret;
+        auto it = std::find_if(_cpus.begin(), _cpus.end(), [cpu](const CpuInfo &info) {
+            return info._cpu == cpu;
+        });
+        if (it == _cpus.end() || it->_l3 == -1)
+        {
+            return ret;
+        }
+        for (auto &info : _cpus)
+        {
+            if (info._l3 == it->_l3)
+            {
+                ret.emplace_back(info._cpu);
+            }
+        }
+        return ret;
+    }
+
+    std::vector<int> CpuTopology::placement(CpuPlacement placement, size_t index, const std::vector<int> &cpuSet) const
+    {
+        std::vector<int> candidates;
+        switch (placement)
+        {
+        case CPU_PLACEMENT_PHYSICAL_CORE:
+            candidates = physicalCores();
+            break;
+        case CPU_PLACEMENT_SMT_SIBLING:
+            candidates = siblingCpus();
+            break;
+        case CPU_PLACEMENT_CPU_SET:
+            candidates = cpuSet;
+            break;
+        case CPU_PLACEMENT_ISOLATE:
+            return cpuSet;
+        default:
+            break;
+        }
+        if (candidates.empty())
+        {
+            return candidates;
+        }
+        return std::vector<int>(1, candidates[index % candidates.size()]);
+    }
+}
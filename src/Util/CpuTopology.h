@@ -0,0 +1,82 @@
+#pragma once
+
+#include <vector>
+#include <string>
+
+namespace JCToolKit
+{
+    //线程绑核策略
+    typedef enum
+    {
+        CPU_PLACEMENT_NONE = 0,      //不绑核，由系统调度
+        CPU_PLACEMENT_PHYSICAL_CORE, //每个线程绑定一个物理核的第一个超线程
+        CPU_PLACEMENT_SMT_SIBLING,   //每个线程绑定一个物理核的兄弟超线程，与PHYSICAL_CORE搭配可与其共享L1/L2
+        CPU_PLACEMENT_CPU_SET,       //在指定的CPU集合内逐个绑定
+        CPU_PLACEMENT_ISOLATE,       //所有线程都限定在指定的CPU集合内
+    } CpuPlacement;
+
+    //从sysfs读取的CPU拓扑信息，读取失败时认为每个逻辑CPU都是独立的物理核
+    class CpuTopology
+    {
+    public:
+        class CpuInfo
+        {
+        public:
+            int _cpu = 0;     //逻辑CPU编号
+            int _core = 0;    //物理核编号(全局唯一)
+            int _package = 0; //CPU插槽
+            int _node = 0;    //NUMA节点
+            int _l3 = -1;     //共享同一L3缓存的CPU中编号最小者，-1为未知
+        };
+
+        static CpuTopology &Instance();
+
+        //由给定的CPU信息构造，_core相同的CPU视为同一物理核上的超线程，可用于自定义拓扑
+        explicit CpuTopology(const std::vector<CpuInfo> &cpus);
+
+        const std::vector<CpuInfo> &cpus() const
+        {
+            return _cpus;
+        }
+
+        size_t physicalCoreCount() const
+        {
+            return _cores.size();
+        }
+
+        //每个物理核的第一个超线程
+        std::vector<int> physicalCores() const;
+
+        //每个物理核的第二个超线程，未开启超线程的核返回其本身
+        std::vector<int> siblingCpus() const;
+
+        //某NUMA节点上的所有CPU
+        std::vector<int> cpusOfNode(int node) const;
+
+        //与cpu共享L3缓存的所有CPU
+        std::vector<int> cpusSharingL3(int cpu) const;
+
+        /**
+         * 按绑核策略为第index个线程选择CPU集合
+         * @param placement 绑核策略
+         * @param index 线程序号
+         * @param cpuSet CPU_PLACEMENT_CPU_SET与CPU_PLACEMENT_ISOLATE使用的CPU集合
+         * @return 应当绑定的CPU集合，为空时不绑核
+         */
+        std::vector<int> placement(CpuPlacement placement, size_t index, const std::vector<int> &cpuSet = std::vector<int>()) const;
+
+        //解析"0-3,8,10-11"格式的CPU列表
+        static std::vector<int> parseCpuList(const std::string &str);
+
+    private:
+        CpuTopology();
+
+        //按_core分组得到每个物理核上的逻辑CPU，并将_core改为物理核序号
+        void load(const std::vector<CpuInfo> &cpus);
+
+    private:
+        std::vector<CpuInfo> _cpus;
+        //每个物理核上的逻辑CPU
+        std::vector<std::vector<int> > _cores;
+    };
+}
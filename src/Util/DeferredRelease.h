@@ -0,0 +1,238 @@
+#pragma once
+
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <functional>
+#include "RingBuffer.h"
+#include "Utilities.h"
+
+namespace JCToolKit
+{
+    //延迟释放统计
+    class ReleaseStatistic
+    {
+    public:
+        uint64_t _deferred = 0; //在其他线程最后释放、转回所属线程释放的对象数，即避免的跨线程释放次数
+        uint64_t _fallback = 0; //队列已满或已关闭，只能在其他线程直接释放的对象数
+        uint64_t _batches = 0;  //批量释放的次数
+    };
+
+    /**
+     * 延迟释放队列，每个事件循环线程一个
+     * 对象在其他线程被最后释放时不直接delete，而是放入所属线程的队列，由所属线程批量释放，
+     * 使内存归还到分配它的线程的分配区，避免跨线程释放在glibc/jemalloc中的额外开销
+     * 对象只记录队列的裸指针，创建与释放时不修改任何共享的引用计数；为此队列通过obtain/recycle复用而从不析构，
+     * 关闭后仍可安全投递(返回false)，数量不超过同时存在的事件循环线程数
+     */
+    class ReleaseQueue : public noncopyable
+    {
+    public:
+        typedef void (*Deleter)(void *ptr);
+
+        /**
+         * 获取一个延迟释放队列，优先复用已回收的队列
+         * @param capacity 队列容量，向上取整为2的幂
+         * @param wakeup 队列积压过半时在投递线程中调用，用于唤醒所属线程尽快释放
+         */
+        static ReleaseQueue *obtain(size_t capacity, std::function<void()> wakeup)
+        {
+            ReleaseQueue *ret = nullptr;
+            {
+                std::lock_guard<std::mutex> lck(freeMutex());
+                auto &list = freeList();
+                for (auto it = list.begin(); it != list.end(); ++it)
+                {
+                    if ((*it)->_queue.capacity() == ringBufferCapacity(capacity))
+                    {
+                        ret = *it;
+                        list.erase(it);
+                        break;
+                    }
+                }
+            }
+            if (!ret)
+            {
+                return new ReleaseQueue(capacity, std::move(wakeup));
+            }
+            ret->reopen(std::move(wakeup));
+            return ret;
+        }
+
+        //关闭并释放剩余对象后放回空闲列表；仍引用该队列的对象此后由释放线程直接释放
+        static void recycle(ReleaseQueue *queue)
+        {
+            if (!queue)
+            {
+                return;
+            }
+            queue->close();
+            queue->drain();
+            std::lock_guard<std::mutex> lck(freeMutex());
+            freeList().emplace_back(queue);
+        }
+
+        //当前线程的延迟释放队列，不在事件循环线程中时为nullptr
+        static ReleaseQueue *&current()
+        {
+            static thread_local ReleaseQueue *s_current = nullptr;
+            return s_current;
+        }
+
+        //投递成功返回true，队列已满或已关闭时返回false，由调用者直接释放
+        bool push(void *ptr, Deleter deleter)
+        {
+            //与close配合：close置位后等待进行中的投递结束，之后的投递都能看到关闭标志
+            _pushing.fetch_add(1);
+            if (_closed.load() || !_queue.push(Item{ptr, deleter}))
+            {
+                _pushing.fetch_sub(1, std::memory_order_release);
+                _fallback.fetch_add(1, std::memory_order_relaxed);
+                return false;
+            }
+            //积压过半时唤醒一次，平时由所属线程在每轮事件循环中顺带释放
+            if (_queue.size() >= _queue.capacity() / 2 && !_wakeupPending.exchange(true))
+            {
+                std::lock_guard<std::mutex> lck(_mtxWakeup);
+                if (_wakeup)
+                {
+                    _wakeup();
+                }
+            }
+            _pushing.fetch_sub(1, std::memory_order_release);
+            return true;
+        }
+
+        //在所属线程中调用，释放队列中的所有对象，返回释放的个数
+        size_t drain()
+        {
+            size_t count = 0;
+            Item item;
+            while (_queue.pop(item))
+            {
+                item._deleter(item._ptr);
+                ++count;
+            }
+            _wakeupPending.store(false, std::memory_order_relaxed);
+            if (count)
+            {
+                _deferred.fetch_add(count, std::memory_order_relaxed);
+                _batches.fetch_add(1, std::memory_order_relaxed);
+            }
+            return count;
+        }
+
+        //所属线程退出前调用，返回后不会再有对象进入队列，之后投递的对象由投递线程直接释放
+        void close()
+        {
+            _closed.store(true);
+            while (_pushing.load(std::memory_order_acquire))
+            {
+                std::this_thread::yield();
+            }
+            std::lock_guard<std::mutex> lck(_mtxWakeup);
+            _wakeup = nullptr;
+        }
+
+        ReleaseStatistic getStatistic() const
+        {
+            ReleaseStatistic ret;
+            ret._deferred = _deferred.load(std::memory_order_relaxed);
+            ret._fallback = _fallback.load(std::memory_order_relaxed);
+            ret._batches = _batches.load(std::memory_order_relaxed);
+            return ret;
+        }
+
+    private:
+        ReleaseQueue(size_t capacity, std::function<void()> wakeup) : _queue(capacity), _wakeup(std::move(wakeup)) {}
+
+        ~ReleaseQueue() = delete;
+
+        //复用前重置状态，统计从零开始
+        void reopen(std::function<void()> wakeup)
+        {
+            {
+                std::lock_guard<std::mutex> lck(_mtxWakeup);
+                _wakeup = std::move(wakeup);
+            }
+            _wakeupPending.store(false, std::memory_order_relaxed);
+            _deferred.store(0, std::memory_order_relaxed);
+            _fallback.store(0, std::memory_order_relaxed);
+            _batches.store(0, std::memory_order_relaxed);
+            _closed.store(false);
+        }
+
+        static std::mutex &freeMutex()
+        {
+            static std::mutex s_mutex;
+            return s_mutex;
+        }
+
+        static std::vector<ReleaseQueue *> &freeList()
+        {
+            //进程退出时不析构，避免与仍在释放对象的线程竞争
+            static auto s_list = new std::vector<ReleaseQueue *>();
+            return *s_list;
+        }
+
+    private:
+        class Item
+        {
+        public:
+            void *_ptr;
+            Deleter _deleter;
+        };
+
+        MpmcRingBuffer<Item> _queue;
+        std::atomic<bool> _closed{false};
+        //正在投递的线程数
+        std::atomic<size_t> _pushing{0};
+        std::atomic<bool> _wakeupPending{false};
+        std::mutex _mtxWakeup;
+        std::function<void()> _wakeup;
+
+        std::atomic<uint64_t> _deferred{0};
+        std::atomic<uint64_t> _fallback{0};
+        std::atomic<uint64_t> _batches{0};
+    };
+
+    /**
+     * shared_ptr的删除器，记录创建时所在线程的延迟释放队列
+     * 在所属线程或没有所属队列时直接delete，否则转回所属线程释放
+     */
+    template <typename T>
+    class HomeDeleter
+    {
+    public:
+        HomeDeleter() {}
+
+        explicit HomeDeleter(ReleaseQueue *home) : _home(home) {}
+
+        void operator()(T *ptr) const
+        {
+            if (!_home || ReleaseQueue::current() == _home || !_home->push(ptr, &HomeDeleter::destroy))
+            {
+                delete ptr;
+            }
+        }
+
+    private:
+        static void destroy(void *ptr)
+        {
+            delete static_cast<T *>(ptr);
+        }
+
+    private:
+        //队列从不析构，不需要持有引用
+        ReleaseQueue *_home = nullptr;
+    };
+
+    //创建对象，最后一次释放发生在其他线程时转回当前线程释放
+    template <typename T>
+    std::shared_ptr<T> makeHomeShared(T *ptr)
+    {
+        return std::shared_ptr<T>(ptr, HomeDeleter<T>(ReleaseQueue::current()));
+    }
+}
@@ -0,0 +1,245 @@
+#pragma once
+
+#include <new>
+#include <atomic>
+#include <memory>
+#include <utility>
+#include <type_traits>
+#include <cstddef>
+#include <cstdint>
+
+namespace JCToolKit
+{
+    //将容量向上取整为2的幂，以便用位与代替取模
+    inline size_t ringBufferCapacity(size_t capacity)
+    {
+        size_t ret = 2;
+        while (ret < capacity)
+        {
+            ret <<= 1;
+        }
+        return ret;
+    }
+
+    /**
+     * 有界单生产者单消费者无锁环形队列
+     * 同一时刻只能有一个线程push、一个线程pop
+     */
+    template <typename T>
+    class SpscRingBuffer
+    {
+    public:
+        explicit SpscRingBuffer(size_t capacity)
+            : _mask(ringBufferCapacity(capacity) - 1), _buffer(new Storage[_mask + 1]) {}
+
+        ~SpscRingBuffer()
+        {
+            for (auto pos = _head.load(); pos != _tail.load(); ++pos)
+            {
+                reinterpret_cast<T *>(&_buffer[pos & _mask])->~T();
+            }
+        }
+
+        //队列已满时返回false，item不会被移动
+        template <typename U>
+        bool push(U &&item)
+        {
+            auto tail = _tail.load(std::memory_order_relaxed);
+            if (tail - _cachedHead > _mask)
+            {
+                _cachedHead = _head.load(std::memory_order_acquire);
+                if (tail - _cachedHead > _mask)
+                {
+                    return false;
+                }
+            }
+            new (&_buffer[tail & _mask]) T(std::forward<U>(item));
+            _tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        //队列为空时返回false
+        bool pop(T &item)
+        {
+            auto head = _head.load(std::memory_order_relaxed);
+            if (head == _cachedTail)
+            {
+                _cachedTail = _tail.load(std::memory_order_acquire);
+                if (head == _cachedTail)
+                {
+                    return false;
+                }
+            }
+            auto ptr = reinterpret_cast<T *>(&_buffer[head & _mask]);
+            item = std::move(*ptr);
+            ptr->~T();
+            _head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        //近似值
+        size_t size() const
+        {
+            auto head = _head.load(std::memory_order_acquire);
+            auto tail = _tail.load(std::memory_order_acquire);
+            return tail > head ? tail - head : 0;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        size_t capacity() const
+        {
+            return _mask + 1;
+        }
+
+    private:
+        SpscRingBuffer(const SpscRingBuffer &) = delete;
+        SpscRingBuffer &operator=(const SpscRingBuffer &) = delete;
+
+        typedef typename std::aligned_storage<sizeof(T), alignof(T)>::type Storage;
+
+        const size_t _mask;
+        std::unique_ptr<Storage[]> _buffer;
+
+        //生产者与消费者各自的下标分处不同缓存行，避免伪共享
+        char _pad0[64];
+        std::atomic<size_t> _head{0};
+        size_t _cachedTail = 0;
+        char _pad1[64];
+        std::atomic<size_t> _tail{0};
+        size_t _cachedHead = 0;
+        char _pad2[64];
+    };
+
+    /**
+     * 有界多生产者多消费者无锁环形队列(Vyukov算法)
+     * 每个槽位带序号，生产者与消费者分别通过CAS争抢下标
+     */
+    template <typename T>
+    class MpmcRingBuffer
+    {
+    public:
+        explicit MpmcRingBuffer(size_t capacity)
+            : _mask(ringBufferCapacity(capacity) - 1), _cells(new Cell[_mask + 1])
+        {
+            for (size_t i = 0; i <= _mask; ++i)
+            {
+                _cells[i]._sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        ~MpmcRingBuffer()
+        {
+            for (auto pos = _head.load(); pos != _tail.load(); ++pos)
+            {
+                reinterpret_cast<T *>(&_cells[pos & _mask]._storage)->~T();
+            }
+        }
+
+        //队列已满时返回false，item不会被移动
+        template <typename U>
+        bool push(U &&item)
+        {
+            Cell *cell;
+            auto pos = _tail.load(std::memory_order_relaxed);
+            while (true)
+            {
+                cell = &_cells[pos & _mask];
+                auto seq = cell->_sequence.load(std::memory_order_acquire);
+                auto diff = (intptr_t)seq - (intptr_t)pos;
+                if (diff == 0)
+                {
+                    if (_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = _tail.load(std::memory_order_relaxed);
+                }
+            }
+            new (&cell->_storage) T(std::forward<U>(item));
+            cell->_sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        //队列为空时返回false
+        bool pop(T &item)
+        {
+            Cell *cell;
+            auto pos = _head.load(std::memory_order_relaxed);
+            while (true)
+            {
+                cell = &_cells[pos & _mask];
+                auto seq = cell->_sequence.load(std::memory_order_acquire);
+                auto diff = (intptr_t)seq - (intptr_t)(pos + 1);
+                if (diff == 0)
+                {
+                    if (_head.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed))
+                    {
+                        break;
+                    }
+                }
+                else if (diff < 0)
+                {
+                    return false;
+                }
+                else
+                {
+                    pos = _head.load(std::memory_order_relaxed);
+                }
+            }
+            auto ptr = reinterpret_cast<T *>(&cell->_storage);
+            item = std::move(*ptr);
+            ptr->~T();
+            cell->_sequence.store(pos + _mask + 1, std::memory_order_release);
+            return true;
+        }
+
+        //近似值
+        size_t size() const
+        {
+            auto head = _head.load(std::memory_order_acquire);
+            auto tail = _tail.load(std::memory_order_acquire);
+            return tail > head ? tail - head : 0;
+        }
+
+        bool empty() const
+        {
+            return size() == 0;
+        }
+
+        size_t capacity() const
+        {
+            return _mask + 1;
+        }
+
+    private:
+        MpmcRingBuffer(const MpmcRingBuffer &) = delete;
+        MpmcRingBuffer &operator=(const MpmcRingBuffer &) = delete;
+
+        class Cell
+        {
+        public:
+            std::atomic<size_t> _sequence;
+            typename std::aligned_storage<sizeof(T), alignof(T)>::type _storage;
+        };
+
+        const size_t _mask;
+        std::unique_ptr<Cell[]> _cells;
+
+        char _pad0[64];
+        std::atomic<size_t> _head{0};
+        char _pad1[64];
+        std::atomic<size_t> _tail{0};
+        char _pad2[64];
+    };
+}
@@ -0,0 +1,123 @@
+#pragma once
+
+#include <new>
+#include <stddef.h>
+
+namespace JCToolKit
+{
+    //线程本地的定长内存块缓存，在同一线程上释放后再申请无需malloc
+    template <size_t BlockSize, size_t MaxCache = 1024>
+    class ThreadLocalBlockCache
+    {
+    public:
+        static void *allocate()
+        {
+            auto &cache = local();
+            if (cache._head)
+            {
+                auto node = cache._head;
+                cache._head = node->_next;
+                --cache._size;
+                return node;
+            }
+            return ::operator new(BlockSize);
+        }
+
+        static void deallocate(void *ptr)
+        {
+            auto &cache = local();
+            if (cache._size >= cache._max)
+            {
+                ::operator delete(ptr);
+                return;
+            }
+            auto node = static_cast<FreeNode *>(ptr);
+            node->_next = cache._head;
+            cache._head = node;
+            ++cache._size;
+        }
+
+    private:
+        class FreeNode
+        {
+        public:
+            FreeNode *_next;
+        };
+
+        class Cache
+        {
+        public:
+            ~Cache()
+            {
+                //线程退出后不再缓存
+                _max = 0;
+                while (_head)
+                {
+                    auto node = _head;
+                    _head = node->_next;
+                    ::operator delete(node);
+                }
+                _size = 0;
+            }
+
+        public:
+            FreeNode *_head = nullptr;
+            size_t _size = 0;
+            size_t _max = MaxCache;
+        };
+
+        static Cache &local()
+        {
+            static thread_local Cache s_cache;
+            return s_cache;
+        }
+    };
+
+    //配合std::allocate_shared使用的分配器，单个对象的分配走线程本地缓存
+    template <typename T>
+    class ThreadLocalAllocator
+    {
+    public:
+        typedef T value_type;
+
+        ThreadLocalAllocator() {}
+
+        template <typename U>
+        ThreadLocalAllocator(const ThreadLocalAllocator<U> &) {}
+
+        T *allocate(size_t n)
+        {
+            if (n == 1)
+            {
+                return static_cast<T *>(Cache::allocate());
+            }
+            return static_cast<T *>(::operator new(n * sizeof(T)));
+        }
+
+        void deallocate(T *ptr, size_t n)
+        {
+            if (n == 1)
+            {
+                Cache::deallocate(ptr);
+                return;
+            }
+            ::operator delete(ptr);
+        }
+
+        template <typename U>
+        bool operator==(const ThreadLocalAllocator<U> &) const
+        {
+            return true;
+        }
+
+        template <typename U>
+        bool operator!=(const ThreadLocalAllocator<U> &) const
+        {
+            return false;
+        }
+
+    private:
+        //内存块至少要能容纳空闲链表指针
+        typedef ThreadLocalBlockCache<(sizeof(T) > sizeof(void *) ? sizeof(T) : sizeof(void *))> Cache;
+    };
+}
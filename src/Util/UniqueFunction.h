@@ -0,0 +1,277 @@
+#pragma once
+
+#include <new>
+#include <memory>
+#include <utility>
+#include <functional>
+#include <type_traits>
+#include <cstddef>
+
+namespace JCToolKit
+{
+    /**
+     * 只可移动的函数对象，与std::function用法一致但不要求可拷贝，
+     * 可以捕获unique_ptr等只可移动的对象
+     * 不超过BufferSize字节且移动构造不抛异常的可调用对象直接存放在内部缓存中，无需堆分配
+     */
+    template <typename Signature, size_t BufferSize = 64>
+    class unique_function;
+
+    template <typename R, typename... ArgTypes, size_t BufferSize>
+    class unique_function<R(ArgTypes...), BufferSize>
+    {
+    private:
+        template <typename F>
+        static auto checkCallable(int) -> decltype(std::declval<F &>()(std::declval<ArgTypes>()...), std::true_type());
+
+        template <typename F>
+        static std::false_type checkCallable(...);
+
+        template <typename F>
+        class IsCallable : public decltype(checkCallable<F>(0))
+        {
+        };
+
+    public:
+        unique_function() noexcept {}
+
+        unique_function(std::nullptr_t) noexcept {}
+
+        template <typename FUNC,
+                  typename = typename std::enable_if<!std::is_same<typename std::decay<FUNC>::type, unique_function>::value &&
+                                                     IsCallable<typename std::decay<FUNC>::type>::value>::type>
+        unique_function(FUNC &&func)
+        {
+            assign(std::forward<FUNC>(func));
+        }
+
+        unique_function(unique_function &&that) noexcept
+        {
+            moveFrom(that);
+        }
+
+        ~unique_function()
+        {
+            reset();
+        }
+
+        unique_function &operator=(unique_function &&that) noexcept
+        {
+            if (this != &that)
+            {
+                reset();
+                moveFrom(that);
+            }
+            return *this;
+        }
+
+        unique_function &operator=(std::nullptr_t) noexcept
+        {
+            reset();
+            return *this;
+        }
+
+        template <typename FUNC,
+                  typename = typename std::enable_if<!std::is_same<typename std::decay<FUNC>::type, unique_function>::value &&
+                                                     IsCallable<typename std::decay<FUNC>::type>::value>::type>
+        unique_function &operator=(FUNC &&func)
+        {
+            unique_function tmp(std::forward<FUNC>(func));
+            return *this = std::move(tmp);
+        }
+
+        explicit operator bool() const noexcept
+        {
+            return _ops != nullptr;
+        }
+
+        R operator()(ArgTypes... args) const
+        {
+            if (!_ops)
+            {
+                throw std::bad_function_call();
+            }
+            return _ops->invoke(const_cast<Storage *>(&_storage), std::forward<ArgTypes>(args)...);
+        }
+
+        void swap(unique_function &that) noexcept
+        {
+            unique_function tmp(std::move(that));
+            that = std::move(*this);
+            *this = std::move(tmp);
+        }
+
+    private:
+        unique_function(const unique_function &) = delete;
+        unique_function &operator=(const unique_function &) = delete;
+
+        typedef typename std::aligned_storage<BufferSize, alignof(std::max_align_t)>::type Storage;
+
+        class Operations
+        {
+        public:
+            R (*invoke)(void *storage, ArgTypes &&...args);
+            void (*move)(void *dst, void *src);
+            void (*destroy)(void *storage);
+        };
+
+        //存放在内部缓存中
+        template <typename F>
+        class InlineOperations
+        {
+        public:
+            static F *get(void *storage)
+            {
+                return static_cast<F *>(storage);
+            }
+
+            static R invoke(void *storage, ArgTypes &&...args)
+            {
+                return (*get(storage))(std::forward<ArgTypes>(args)...);
+            }
+
+            static void move(void *dst, void *src)
+            {
+                new (dst) F(std::move(*get(src)));
+                get(src)->~F();
+            }
+
+            static void destroy(void *storage)
+            {
+                get(storage)->~F();
+            }
+
+            static const Operations *table()
+            {
+                static const Operations s_ops = {&invoke, &move, &destroy};
+                return &s_ops;
+            }
+        };
+
+        //过大的对象存放在堆上，内部缓存只保存指针
+        template <typename F>
+        class HeapOperations
+        {
+        public:
+            static F *&get(void *storage)
+            {
+                return *static_cast<F **>(storage);
+            }
+
+            static R invoke(void *storage, ArgTypes &&...args)
+            {
+                return (*get(storage))(std::forward<ArgTypes>(args)...);
+            }
+
+            static void move(void *dst, void *src)
+            {
+                new (dst) F *(get(src));
+                get(src) = nullptr;
+            }
+
+            static void destroy(void *storage)
+            {
+                delete get(storage);
+            }
+
+            static const Operations *table()
+            {
+                static const Operations s_ops = {&invoke, &move, &destroy};
+                return &s_ops;
+            }
+        };
+
+        template <typename F>
+        class IsInline
+        {
+        public:
+            static const bool value = sizeof(F) <= sizeof(Storage) && alignof(F) <= alignof(Storage) &&
+                                      std::is_nothrow_move_constructible<F>::value;
+        };
+
+        //空的函数指针或std::function视为空
+        template <typename F>
+        static bool isNull(const F &)
+        {
+            return false;
+        }
+
+        template <typename T>
+        static bool isNull(T *ptr)
+        {
+            return ptr == nullptr;
+        }
+
+        template <typename Sig>
+        static bool isNull(const std::function<Sig> &func)
+        {
+            return !func;
+        }
+
+        template <typename Sig, size_t Size>
+        static bool isNull(const unique_function<Sig, Size> &func)
+        {
+            return !func;
+        }
+
+        template <typename FUNC>
+        typename std::enable_if<IsInline<typename std::decay<FUNC>::type>::value>::type assign(FUNC &&func)
+        {
+            typedef typename std::decay<FUNC>::type F;
+            if (isNull(func))
+            {
+                return;
+            }
+            new (&_storage) F(std::forward<FUNC>(func));
+            _ops = InlineOperations<F>::table();
+        }
+
+        template <typename FUNC>
+        typename std::enable_if<!IsInline<typename std::decay<FUNC>::type>::value>::type assign(FUNC &&func)
+        {
+            typedef typename std::decay<FUNC>::type F;
+            if (isNull(func))
+            {
+                return;
+            }
+            new (&_storage) F *(new F(std::forward<FUNC>(func)));
+            _ops = HeapOperations<F>::table();
+        }
+
+        void moveFrom(unique_function &that) noexcept
+        {
+            if (that._ops)
+            {
+                that._ops->move(&_storage, &that._storage);
+                _ops = that._ops;
+                that._ops = nullptr;
+            }
+        }
+
+        void reset() noexcept
+        {
+            if (_ops)
+            {
+                auto ops = _ops;
+                _ops = nullptr;
+                ops->destroy(&_storage);
+            }
+        }
+
+    private:
+        Storage _storage;
+        const Operations *_ops = nullptr;
+    };
+
+    template <typename Signature, size_t BufferSize>
+    bool operator==(const unique_function<Signature, BufferSize> &func, std::nullptr_t)
+    {
+        return !func;
+    }
+
+    template <typename Signature, size_t BufferSize>
+    bool operator!=(const unique_function<Signature, BufferSize> &func, std::nullptr_t)
+    {
+        return static_cast<bool>(func);
+    }
+}
@@ -80,6 +80,62 @@ namespace JCToolKit
         task _onDestructed;
     };
 
+    /**
+     * 分片计数器，各线程按线程序号写入不同缓存行上的分片，避免多核同时计数时争抢同一缓存行
+     * 读取时累加所有分片，开销较大，适合写多读少的统计
+     */
+    class ShardedCounter : public noncopyable
+    {
+    public:
+        ShardedCounter() {}
+
+        void add(int64_t value)
+        {
+            _shards[shardIndex()]._value.fetch_add(value, std::memory_order_relaxed);
+        }
+
+        ShardedCounter &operator++()
+        {
+            add(1);
+            return *this;
+        }
+
+        ShardedCounter &operator--()
+        {
+            add(-1);
+            return *this;
+        }
+
+        size_t load() const
+        {
+            int64_t ret = 0;
+            for (auto &shard : _shards)
+            {
+                ret += shard._value.load(std::memory_order_relaxed);
+            }
+            return ret > 0 ? ret : 0;
+        }
+
+    private:
+        static const size_t s_shardCount = 64;
+
+        //线程首次计数时分配序号，线程数不超过分片数时互不共享
+        static size_t shardIndex()
+        {
+            static std::atomic<size_t> s_next(0);
+            static thread_local size_t s_index = s_next++ % s_shardCount;
+            return s_index;
+        }
+
+        class alignas(64) Shard
+        {
+        public:
+            std::atomic<int64_t> _value{0};
+        };
+
+        Shard _shards[s_shardCount];
+    };
+
     template <class T>
     class ObjectStatistic
     {
@@ -100,15 +156,15 @@ namespace JCToolKit
         }
 
     private:
-        static std::atomic<size_t> &getCounter();
+        static ShardedCounter &getCounter();
     };
 
-#define StatisticImp(Type)                              \
-    template <>                                         \
-    atomic<size_t> &ObjectStatistic<Type>::getCounter() \
-    {                                                   \
-        static atomic<size_t> instance(0);              \
-        return instance;                                \
+#define StatisticImp(Type)                                 \
+    template <>                                            \
+    ShardedCounter &ObjectStatistic<Type>::getCounter()    \
+    {                                                      \
+        static ShardedCounter instance;                    \
+        return instance;                                   \
     }
 
     class StrPrinter : public std::string
@@ -133,12 +189,14 @@ namespace JCToolKit
         std::stringstream _stream;
     };
 
-#define StatisticImp(Type)                              \
-    template <>                                         \
-    std::atomic<size_t> &ObjectStatistic<Type>::getCounter() \
-    {                                                   \
-        static std::atomic<size_t> instance(0);              \
-        return instance;                                \
+    //自旋等待时提示CPU降低功耗并让出流水线给超线程
+    inline void cpuRelax()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__) || defined(__arm__)
+        asm volatile("yield" ::: "memory");
+#endif
     }
 
     uint64_t getCurrentMillisecond(bool isSystemTime = false);
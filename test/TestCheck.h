@@ -0,0 +1,13 @@
+#pragma once
+
+#include <iostream>
+
+namespace JCToolKit
+{
+    //打印一项检查的结果，返回是否通过，便于测试以返回码汇总结果
+    inline bool check(bool ok, const char *what)
+    {
+        std::cout << (ok ? "通过:" : "失败:") << what << std::endl;
+        return ok;
+    }
+}
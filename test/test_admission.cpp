@@ -0,0 +1,132 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include "Poller/EventPoller.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//阻塞poller线程，使提交的任务都留在队列中
+static void blockPoller(const EventPoller::Ptr &poller, Semaphore &started, Semaphore &release)
+{
+    poller->async([&]() {
+        started.post();
+        release.wait();
+    }, false);
+    started.wait();
+}
+
+//队列深度达到限制时普通任务被拒绝，低优先级任务在一半时即被拒绝，高优先级任务不受限制
+static bool testDepth(const EventPoller::Ptr &poller)
+{
+    Semaphore started, release;
+    std::atomic<int> executed{0};
+    poller->setAdmissionLimit(100);
+    blockPoller(poller, started, release);
+
+    int low = 0, normal = 0, high = 0;
+    EventPoller::AdmitResult result;
+    for (int i = 0; i < 60; ++i)
+    {
+        poller->asyncAdmit([&]() { ++executed; }, EventPoller::ADMIT_LOW, &result);
+        low += result == EventPoller::ADMIT_OK;
+    }
+    for (int i = 0; i < 60; ++i)
+    {
+        poller->asyncAdmit([&]() { ++executed; }, EventPoller::ADMIT_NORMAL, &result);
+        normal += result == EventPoller::ADMIT_OK;
+    }
+    for (int i = 0; i < 10; ++i)
+    {
+        poller->asyncAdmit([&]() { ++executed; }, EventPoller::ADMIT_HIGH, &result);
+        high += result == EventPoller::ADMIT_OK;
+    }
+    release.post();
+
+    Semaphore done;
+    poller->async([&]() { done.post(); }, false);
+    done.wait();
+    auto statistic = poller->getAdmissionStatistic();
+    bool ok = check(low == 50 && normal == 50 && high == 10, "按优先级在不同深度拒绝");
+    ok = check(executed == 110, "准入的任务全部执行") && ok;
+    return check(statistic._shedDepth == 20 && statistic._shedLow == 10, "拒绝统计") && ok;
+}
+
+//队首任务等待超过限制后拒绝新的普通任务
+static bool testAge(const EventPoller::Ptr &poller)
+{
+    Semaphore started, release;
+    poller->setAdmissionLimit(0, 50);
+    blockPoller(poller, started, release);
+
+    EventPoller::AdmitResult first, late, high;
+    poller->asyncAdmit([]() {}, EventPoller::ADMIT_NORMAL, &first);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    poller->asyncAdmit([]() {}, EventPoller::ADMIT_NORMAL, &late);
+    poller->asyncAdmit([]() {}, EventPoller::ADMIT_HIGH, &high);
+    release.post();
+
+    Semaphore done;
+    poller->async([&]() { done.post(); }, false);
+    done.wait();
+    poller->setAdmissionLimit(0, 0);
+    return check(first == EventPoller::ADMIT_OK && late == EventPoller::ADMIT_REJECT_AGE && high == EventPoller::ADMIT_OK, "队首等待过久时拒绝");
+}
+
+//同池poller线程经信箱投递的任务同样计入队列深度与等待时间
+static bool testMailbox(const EventPoller::Ptr &source, const EventPoller::Ptr &target)
+{
+    Semaphore started, release;
+    target->setAdmissionLimit(5, 50);
+    blockPoller(target, started, release);
+
+    //在来源poller线程中投递，任务进入信箱
+    auto admit = [&](std::vector<EventPoller::AdmitResult> &results, int count) {
+        Semaphore sem;
+        source->async([&]() {
+            for (int i = 0; i < count; ++i)
+            {
+                EventPoller::AdmitResult result;
+                target->asyncAdmit([]() {}, EventPoller::ADMIT_NORMAL, &result);
+                results.emplace_back(result);
+            }
+            sem.post();
+        }, false);
+        sem.wait();
+    };
+    std::vector<EventPoller::AdmitResult> first, late, full;
+    admit(first, 1);
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    admit(late, 1);
+    target->setAdmissionLimit(5, 0);
+    admit(full, 5);
+    release.post();
+
+    Semaphore done;
+    target->async([&]() { done.post(); }, false);
+    done.wait();
+    target->setAdmissionLimit(0, 0);
+    bool ok = check(first.at(0) == EventPoller::ADMIT_OK && late.at(0) == EventPoller::ADMIT_REJECT_AGE, "信箱中的任务等待过久时拒绝");
+    return check(full.at(3) == EventPoller::ADMIT_OK && full.at(4) == EventPoller::ADMIT_REJECT_DEPTH, "信箱中的任务计入队列深度") && ok;
+}
+
+int main()
+{
+    EventPollerPool::setPoolSize(2);
+    EventPollerPool::Instance().resize(2);
+    std::vector<EventPoller::Ptr> pollers;
+    EventPollerPool::Instance().for_each([&](const OperationExecutor::Ptr &executor) {
+        pollers.emplace_back(std::dynamic_pointer_cast<EventPoller>(executor));
+    });
+    if (pollers.size() < 2)
+    {
+        return check(false, "创建两个poller") ? 0 : 1;
+    }
+    bool ok = testDepth(pollers[0]);
+    ok = testAge(pollers[0]) && ok;
+    ok = testMailbox(pollers[0], pollers[1]) && ok;
+    return ok ? 0 : 1;
+}
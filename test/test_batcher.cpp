@@ -0,0 +1,78 @@
+#include <string>
+#include <vector>
+#include <chrono>
+#include <iostream>
+#include "Poller/Batcher.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//等待poller执行完之前投递的任务
+static void sync(const EventPoller::Ptr &poller)
+{
+    Semaphore sem;
+    poller->async([&]() { sem.post(); }, false);
+    sem.wait();
+}
+
+//数据个数达到上限时刷出，跨线程addBatch按单个数据检查上限
+static bool testSize(const EventPoller::Ptr &poller)
+{
+    std::vector<size_t> sizes;
+    auto batcher = Batcher<int>::create(poller, [&](std::vector<int> &items) {
+        sizes.emplace_back(items.size());
+    }, 10, 0);
+    batcher->addBatch(std::vector<int>(25, 1));
+    batcher->flush();
+    sync(poller);
+    auto statistic = batcher->getStatistic();
+    bool ok = check(sizes == std::vector<size_t>({10, 10, 5}), "按数据个数刷出");
+    return check(statistic._flushBySize == 2 && statistic._flushes == 3 && statistic._items == 25, "按数据个数刷出统计") && ok;
+}
+
+//字节数达到上限时刷出
+static bool testBytes(const EventPoller::Ptr &poller)
+{
+    std::vector<size_t> sizes;
+    auto batcher = Batcher<std::string>::create(poller, [&](std::vector<std::string> &items) {
+        sizes.emplace_back(items.size());
+    }, 0, 0, 100, [](const std::string &item) {
+        return item.size();
+    });
+    for (int i = 0; i < 7; ++i)
+    {
+        batcher->add(std::string(30, 'x'));
+    }
+    sync(poller);
+    auto statistic = batcher->getStatistic();
+    //第4个数据使字节数达到120
+    return check(sizes == std::vector<size_t>({4}) && statistic._flushByBytes == 1, "按字节数刷出");
+}
+
+//首个数据等待超时后刷出
+static bool testTime(const EventPoller::Ptr &poller)
+{
+    Semaphore flushed;
+    size_t size = 0;
+    auto batcher = Batcher<int>::create(poller, [&](std::vector<int> &items) {
+        size = items.size();
+        flushed.post();
+    }, 1000, 20 * 1000);
+    auto start = std::chrono::steady_clock::now();
+    batcher->addBatch({1, 2, 3});
+    flushed.wait();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    auto statistic = batcher->getStatistic();
+    std::cout << "超时刷出耗时:" << elapsed << "ms" << std::endl;
+    return check(size == 3 && statistic._flushByTime == 1 && elapsed >= 19 && elapsed < 200, "按等待时间刷出");
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    bool ok = testSize(poller);
+    ok = testBytes(poller) && ok;
+    ok = testTime(poller) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,126 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include "Poller/EventPoller.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/Semaphore.h"
+#include "Thread/CancelToken.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//取消父令牌等同于取消所有子令牌，取消子令牌不影响父令牌
+static bool testHierarchy()
+{
+    auto parent = CancelToken::create();
+    auto child = CancelToken::create(parent);
+    auto grandchild = CancelToken::create(child);
+    auto sibling = CancelToken::create(parent);
+    child->cancel();
+    bool ok = check(child->isCanceled() && grandchild->isCanceled() && !parent->isCanceled() && !sibling->isCanceled(), "取消子令牌不影响父令牌与兄弟令牌");
+    parent->cancel();
+    return check(sibling->isCanceled(), "取消父令牌后子令牌均被取消") && ok;
+}
+
+//Scope退出后恢复之前的令牌，支持嵌套
+static bool testScope()
+{
+    auto outer = CancelToken::create();
+    auto inner = CancelToken::create();
+    bool ok = true;
+    {
+        CancelToken::Scope outerScope(outer);
+        {
+            CancelToken::Scope innerScope(inner);
+            ok = check(CancelToken::current() == inner, "Scope内为新令牌") && ok;
+            {
+                CancelToken::Scope detach(nullptr);
+                ok = check(!CancelToken::current(), "传入nullptr后不绑定令牌") && ok;
+            }
+            ok = check(CancelToken::current() == inner, "内层Scope退出后恢复") && ok;
+        }
+        ok = check(CancelToken::current() == outer, "嵌套Scope退出后恢复外层令牌") && ok;
+    }
+    return check(!CancelToken::current(), "最外层Scope退出后恢复为空") && ok;
+}
+
+//排队中的async任务与定时任务在令牌取消后被跳过，任务中再投递的任务同属该令牌
+static bool testPoller(const EventPoller::Ptr &poller)
+{
+    auto token = CancelToken::create();
+    std::atomic<int> executed{0};
+    std::atomic<bool> nested{false};
+    Semaphore blocked;
+    Semaphore release;
+    //先阻塞poller线程，使后续任务在取消时仍在排队
+    poller->async([&]() {
+        blocked.post();
+        release.wait();
+    }, false);
+    blocked.wait();
+    {
+        CancelToken::Scope scope(token);
+        for (int i = 0; i < 10; ++i)
+        {
+            poller->async([&]() { ++executed; }, false);
+        }
+        poller->startDelayOperation(1, [&]() -> uint64_t {
+            ++executed;
+            return 0;
+        });
+    }
+    token->cancel();
+    release.post();
+
+    //任务执行期间其令牌为当前令牌，再投递的任务在取消后同样被跳过
+    auto other = CancelToken::create();
+    Semaphore inside;
+    {
+        CancelToken::Scope scope(other);
+        poller->async([&]() {
+            nested = CancelToken::current() == other;
+            poller->async([&]() { ++executed; }, false);
+            other->cancel();
+            inside.post();
+        }, false);
+    }
+    inside.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    Semaphore done;
+    poller->async([&]() { done.post(); }, false);
+    done.wait();
+    bool ok = check(nested, "任务执行时其令牌为当前令牌");
+    return check(executed == 0, "令牌取消后排队中的任务与定时任务被跳过") && ok;
+}
+
+//线程池中排队的任务在令牌取消后被跳过，未绑定令牌的任务照常执行
+static bool testThreadPool()
+{
+    ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+    auto token = CancelToken::create();
+    std::atomic<int> executed{0};
+    Semaphore done;
+    {
+        CancelToken::Scope scope(token);
+        for (int i = 0; i < 10; ++i)
+        {
+            pool.async([&]() { ++executed; }, false);
+        }
+    }
+    pool.async([&]() { done.post(); }, false);
+    token->cancel();
+    pool.start();
+    done.wait();
+    return check(executed == 0, "令牌取消后线程池中排队的任务被跳过");
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    bool ok = testHierarchy();
+    ok = testScope() && ok;
+    ok = testPoller(poller) && ok;
+    ok = testThreadPool() && ok;
+    return ok ? 0 : 1;
+}
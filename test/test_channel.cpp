@@ -0,0 +1,112 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include "Poller/Channel.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//多个发送线程满时重试，接收端收到全部数据且每个发送线程的数据保持顺序
+static bool testMultiProducer()
+{
+    const int producers = 4;
+    const int count = 20000;
+    auto poller = EventPollerPool::Instance().getPoller();
+    std::vector<int> last(producers, -1);
+    std::atomic<int> received{0};
+    std::atomic<bool> ordered{true};
+    Semaphore done;
+    auto channel = MpmcChannel<int>::create(poller, 256, [&](std::vector<int> &items) {
+        for (auto item : items)
+        {
+            auto producer = item / count;
+            if (item % count != last[producer] + 1)
+            {
+                ordered = false;
+            }
+            last[producer] = item % count;
+            if (++received == producers * count)
+            {
+                done.post();
+            }
+        }
+    });
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < count; ++j)
+            {
+                while (!channel->send(i * count + j))
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    done.wait();
+    return check(received == producers * count && ordered, "多生产者数据完整且各自有序");
+}
+
+//接收端空闲等待时在其他线程关闭，先收完已发送的数据再回调关闭
+static bool testCloseWhileWaiting()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    std::atomic<int> received{0};
+    std::atomic<int> receivedAtClose{-1};
+    std::atomic<bool> closeInPoller{false};
+    Semaphore closed;
+    auto channel = MpmcChannel<int>::create(poller, 64, [&](std::vector<int> &items) {
+        received += (int)items.size();
+    });
+    channel->setCloseCallBack([&]() {
+        receivedAtClose = received.load();
+        closeInPoller = poller->isCurrentThread();
+        closed.post();
+    });
+
+    std::thread([&]() {
+        for (int i = 0; i < 10; ++i)
+        {
+            channel->send(i);
+        }
+        //等接收端收完进入空闲后再关闭
+        std::this_thread::sleep_for(std::chrono::milliseconds(100));
+        channel->send(10);
+        channel->close();
+    }).join();
+    closed.wait();
+    bool ok = check(receivedAtClose == 11 && closeInPoller, "关闭回调在poller线程中且在已发送数据之后");
+    return check(!channel->send(11) && channel->isClosed(), "关闭后发送失败") && ok;
+}
+
+//不注册接收回调时主动接收，满时只回调一次onFull，取空后回调onEmpty
+static bool testFlowControl()
+{
+    auto channel = SpscChannel<int>::create(EventPollerPool::Instance().getPoller(), 4, nullptr);
+    int full = 0, empty = 0;
+    channel->setFlowCallBack([&]() { ++full; }, [&]() { ++empty; });
+    int sent = 0;
+    for (int i = 0; i < 10; ++i)
+    {
+        sent += channel->send(i);
+    }
+    std::vector<int> items;
+    channel->recv(items, 100);
+    return check(sent == 4 && full == 1 && empty == 1 && items.size() == 4 && channel->fullCount() == 6, "满时拒绝发送并触发流控回调");
+}
+
+int main()
+{
+    bool ok = testMultiProducer();
+    ok = testCloseWhileWaiting() && ok;
+    ok = testFlowControl() && ok;
+    return ok ? 0 : 1;
+}
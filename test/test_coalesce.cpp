@@ -0,0 +1,158 @@
+#include <new>
+#include <atomic>
+#include <cstdlib>
+#include <string>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include "Poller/EventPoller.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//统计当前存活的堆分配个数
+static std::atomic<long> s_live{0};
+
+void *operator new(size_t size)
+{
+    auto ptr = malloc(size ? size : 1);
+    if (!ptr)
+    {
+        throw std::bad_alloc();
+    }
+    ++s_live;
+    return ptr;
+}
+
+void operator delete(void *ptr) noexcept
+{
+    if (ptr)
+    {
+        --s_live;
+        free(ptr);
+    }
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    operator delete(ptr);
+}
+
+//等待poller执行完之前投递的任务
+static void flush(const EventPoller::Ptr &poller)
+{
+    Semaphore sem;
+    poller->async([&]() { sem.post(); }, false);
+    sem.wait();
+}
+
+//重复提交并执行合并任务，存活的分配数不应随次数增长
+static bool testExecuted(const EventPoller::Ptr &poller)
+{
+    std::atomic<int> executed{0};
+    long base = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        poller->asyncCoalesce("refresh", [&]() { ++executed; });
+        poller->asyncCoalesce("refresh", [&]() { ++executed; });
+        flush(poller);
+        if (i == 999)
+        {
+            base = s_live;
+        }
+    }
+    long growth = s_live - base;
+    std::cout << "执行次数:" << executed << " 存活分配数增长:" << growth << std::endl;
+    //第二次提交可能在第一次执行后才到达而重新排队
+    return check(executed >= 10000 && executed <= 20000 && growth < 100, "已执行的合并任务不泄漏");
+}
+
+//提交后立即取消且key不再复用，槽位也应被清理
+static bool testCanceled(const EventPoller::Ptr &poller)
+{
+    long base = 0;
+    for (int i = 0; i < 10000; ++i)
+    {
+        auto operation = poller->asyncCoalesce("cancel" + std::to_string(i), []() {});
+        operation->cancel();
+        auto delay = poller->asyncCoalesce("debounce" + std::to_string(i), []() {}, 1);
+        delay->cancel();
+        if (i % 100 == 99)
+        {
+            flush(poller);
+        }
+        if (i == 999)
+        {
+            base = s_live;
+        }
+    }
+    //等已取消的定时任务到期后从定时器中移除
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    flush(poller);
+    long growth = s_live - base;
+    std::cout << "取消后存活分配数增长:" << growth << std::endl;
+    //槽位表按倍增清理，只会保留少量尚未清理的已取消槽位
+    return check(growth < 1000, "已取消的合并任务不泄漏");
+}
+
+//防抖提交在最后一次提交后执行一次
+static bool testDebounce(const EventPoller::Ptr &poller)
+{
+    std::atomic<int> executed{0};
+    long base = s_live;
+    for (int round = 0; round < 20; ++round)
+    {
+        for (int i = 0; i < 5; ++i)
+        {
+            poller->asyncCoalesce("debounce", [&]() { ++executed; }, 5);
+        }
+        Semaphore sem;
+        poller->startDelayOperation(30, [&]() -> uint64_t {
+            sem.post();
+            return 0;
+        });
+        sem.wait();
+    }
+    long growth = s_live - base;
+    std::cout << "防抖执行次数:" << executed << " 存活分配数增长:" << growth << std::endl;
+    return check(executed == 20 && growth < 100, "防抖任务每轮执行一次且不泄漏");
+}
+
+//同名key交替使用立即执行与防抖两种提交，各自返回有效任务且都会执行
+static bool testMixed(const EventPoller::Ptr &poller)
+{
+    std::atomic<int> immediate{0};
+    std::atomic<int> debounced{0};
+    Semaphore blocked;
+    Semaphore release;
+    //阻塞poller线程，使立即执行的任务在两种提交期间一直在排队
+    poller->async([&]() {
+        blocked.post();
+        release.wait();
+    }, false);
+    blocked.wait();
+    auto operation = poller->asyncCoalesce("mixed", [&]() { ++immediate; });
+    auto delay = poller->asyncCoalesce("mixed", [&]() { ++debounced; }, 5);
+    auto operation2 = poller->asyncCoalesce("mixed", [&]() { ++immediate; });
+    auto delay2 = poller->asyncCoalesce("mixed", [&]() { ++debounced; }, 5);
+    release.post();
+    Semaphore sem;
+    poller->startDelayOperation(30, [&]() -> uint64_t {
+        sem.post();
+        return 0;
+    });
+    sem.wait();
+    bool ok = check(operation && operation == operation2 && delay && delay == delay2, "两种提交各自合并并返回有效任务");
+    return check(immediate == 1 && debounced == 1, "两种提交的任务各执行一次") && ok;
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    bool ok = testExecuted(poller);
+    ok = testCanceled(poller) && ok;
+    ok = testDebounce(poller) && ok;
+    ok = testMixed(poller) && ok;
+    return ok ? 0 : 1;
+}
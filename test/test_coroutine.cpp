@@ -0,0 +1,128 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include <stdexcept>
+#include <unistd.h>
+#include "Poller/EventPoller.h"
+#include "Poller/Coroutine.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+#if defined(ENABLE_COROUTINE)
+
+static Task<int> add(int a, int b)
+{
+    co_return a + b;
+}
+
+static Task<int> thrower()
+{
+    throw std::runtime_error("test");
+    co_return 0;
+}
+
+//嵌套等待、异常传递与等待已移走的Task
+static Task<void> testTask(bool &ok, Semaphore &done)
+{
+    int value = co_await add(1, 2);
+    value = co_await add(value, value);
+    ok = check(value == 6, "嵌套co_await返回结果");
+
+    bool caught = false;
+    try
+    {
+        co_await thrower();
+    }
+    catch (std::runtime_error &)
+    {
+        caught = true;
+    }
+    ok = check(caught, "协程异常传递给等待者") && ok;
+
+    auto task = add(1, 1);
+    auto moved = std::move(task);
+    caught = false;
+    try
+    {
+        co_await task;
+    }
+    catch (std::logic_error &)
+    {
+        caught = true;
+    }
+    ok = check(caught && co_await moved == 2, "等待已移走的Task抛出异常") && ok;
+    done.post();
+}
+
+//切换到poller线程并在其中休眠
+static Task<void> testSchedule(EventPoller::Ptr poller, bool &ok, Semaphore &done)
+{
+    co_await poller->schedule();
+    ok = check(poller->isCurrentThread(), "schedule切换到执行器线程");
+    auto start = getCurrentMillisecond();
+    co_await poller->sleep(50);
+    ok = check(poller->isCurrentThread() && getCurrentMillisecond() - start >= 45, "sleep在poller线程中恢复") && ok;
+    done.post();
+}
+
+//在非poller线程中等待fd，注册切换到poller线程完成
+static Task<void> testReadable(EventPoller::Ptr poller, int fd, int &event, bool &onPoller, Semaphore &done)
+{
+    event = co_await readable(fd, poller);
+    onPoller = poller->isCurrentThread();
+    done.post();
+}
+
+static bool testIo(const EventPoller::Ptr &poller)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return check(false, "创建管道");
+    }
+    int event = 0;
+    bool onPoller = false;
+    Semaphore done;
+    testReadable(poller, fds[0], event, onPoller, done).start();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    if (write(fds[1], "x", 1) != 1)
+    {
+        return check(false, "写管道");
+    }
+    done.wait();
+    bool ok = check((event & PollEventRead) && onPoller, "非poller线程中等待fd可读");
+
+    //注册失败时以错误事件恢复，而不是永远挂起
+    testReadable(poller, -1, event, onPoller, done).start();
+    done.wait();
+    ok = check(event == PollEventError, "非poller线程中注册失败时返回错误事件") && ok;
+    close(fds[0]);
+    close(fds[1]);
+    return ok;
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    bool taskOk = false, scheduleOk = false;
+    Semaphore done;
+    testTask(taskOk, done).start();
+    done.wait();
+    testSchedule(poller, scheduleOk, done).start();
+    done.wait();
+    bool ok = testIo(poller);
+    return taskOk && scheduleOk && ok ? 0 : 1;
+}
+
+#else
+
+int main()
+{
+    check(true, "未启用ENABLE_COROUTINE，跳过协程测试");
+    return 0;
+}
+
+#endif // ENABLE_COROUTINE
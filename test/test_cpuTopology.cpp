@@ -0,0 +1,65 @@
+#include <vector>
+#include <iostream>
+#include "Util/CpuTopology.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//解析"0-3,8,10-11"格式的CPU列表
+static bool testParse()
+{
+    bool ok = check(CpuTopology::parseCpuList("0-3,8,10-11") == std::vector<int>({0, 1, 2, 3, 8, 10, 11}), "解析区间与单个CPU");
+    ok = check(CpuTopology::parseCpuList("5") == std::vector<int>({5}), "解析单个CPU") && ok;
+    return check(CpuTopology::parseCpuList("").empty() && CpuTopology::parseCpuList("1,,2") == std::vector<int>({1, 2}), "忽略空项") && ok;
+}
+
+//两个NUMA节点、每节点两个物理核、每核两个超线程，超线程编号与Linux一样间隔排列
+static CpuTopology makeTopology()
+{
+    std::vector<CpuTopology::CpuInfo> cpus;
+    for (int cpu = 0; cpu < 8; ++cpu)
+    {
+        CpuTopology::CpuInfo info;
+        info._cpu = cpu;
+        info._core = 100 + cpu % 4;
+        info._node = (cpu % 4) / 2;
+        info._package = info._node;
+        info._l3 = info._node * 2;
+        cpus.emplace_back(info);
+    }
+    return CpuTopology(cpus);
+}
+
+//各绑核策略按拓扑选择CPU
+static bool testPlacement()
+{
+    auto topology = makeTopology();
+    bool ok = check(topology.physicalCoreCount() == 4, "按_core分组得到物理核");
+    ok = check(topology.physicalCores() == std::vector<int>({0, 1, 2, 3}), "每个物理核的第一个超线程") && ok;
+    ok = check(topology.siblingCpus() == std::vector<int>({4, 5, 6, 7}), "每个物理核的兄弟超线程") && ok;
+    ok = check(topology.cpusOfNode(1) == std::vector<int>({2, 3, 6, 7}), "NUMA节点上的CPU") && ok;
+    ok = check(topology.cpusSharingL3(5) == std::vector<int>({0, 1, 4, 5}), "共享L3缓存的CPU") && ok;
+
+    std::vector<int> physical;
+    std::vector<int> sibling;
+    for (size_t index = 0; index < 6; ++index)
+    {
+        physical.emplace_back(topology.placement(CPU_PLACEMENT_PHYSICAL_CORE, index).at(0));
+        sibling.emplace_back(topology.placement(CPU_PLACEMENT_SMT_SIBLING, index).at(0));
+    }
+    ok = check(physical == std::vector<int>({0, 1, 2, 3, 0, 1}), "PHYSICAL_CORE逐个绑定物理核并循环") && ok;
+    ok = check(sibling == std::vector<int>({4, 5, 6, 7, 4, 5}), "SMT_SIBLING逐个绑定兄弟超线程并循环") && ok;
+
+    std::vector<int> cpuSet({8, 10, 11});
+    ok = check(topology.placement(CPU_PLACEMENT_CPU_SET, 4, cpuSet) == std::vector<int>({10}), "CPU_SET在集合内逐个绑定") && ok;
+    ok = check(topology.placement(CPU_PLACEMENT_ISOLATE, 4, cpuSet) == cpuSet, "ISOLATE限定在整个集合内") && ok;
+    ok = check(topology.placement(CPU_PLACEMENT_NONE, 0).empty() && topology.placement(CPU_PLACEMENT_CPU_SET, 0).empty(), "不绑核或集合为空时返回空") && ok;
+    return ok;
+}
+
+int main()
+{
+    bool ok = testParse();
+    ok = testPlacement() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,113 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <mutex>
+#include <iostream>
+#include "Thread/ThreadPool.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//记录任务执行顺序，全部执行后通知
+class Recorder
+{
+public:
+    Recorder(size_t total) : _total(total) {}
+
+    OperationFunction record(int id)
+    {
+        return [this, id]() {
+            std::lock_guard<std::mutex> lck(_mtx);
+            _order.emplace_back(id);
+            if (_order.size() == _total)
+            {
+                _done.post();
+            }
+        };
+    }
+
+    std::vector<int> wait()
+    {
+        _done.wait();
+        std::lock_guard<std::mutex> lck(_mtx);
+        return _order;
+    }
+
+private:
+    size_t _total;
+    std::mutex _mtx;
+    std::vector<int> _order;
+    Semaphore _done;
+};
+
+//截止时间越早越先执行，且先于普通任务
+static bool testOrder()
+{
+    ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+    Recorder recorder(6);
+    pool.async(recorder.record(0));
+    pool.asyncDeadline(recorder.record(50), 5000);
+    pool.asyncDeadline(recorder.record(10), 1000);
+    pool.asyncDeadline(recorder.record(30), 3000);
+    pool.asyncDeadline(recorder.record(20), 2000);
+    pool.asyncDeadline(recorder.record(40), 4000);
+    pool.start();
+    return check(recorder.wait() == std::vector<int>({10, 20, 30, 40, 50, 0}), "按截止时间最早优先执行");
+}
+
+//错过截止时间的任务被丢弃
+static bool testDrop()
+{
+    ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+    pool.setDeadlinePolicy(ThreadPool::DEADLINE_DROP);
+    Recorder recorder(1);
+    std::atomic<bool> dropped{true};
+    pool.asyncDeadline([&]() { dropped = false; }, 0);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    pool.async(recorder.record(0));
+    pool.start();
+    recorder.wait();
+    return check(dropped && pool.deadlineMissCount() == 1 && pool.deadlineDropCount() == 1, "错过截止时间的任务被丢弃并计数");
+}
+
+//错过截止时间的任务降级到普通队列末尾，仍会执行
+static bool testDemote()
+{
+    ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+    pool.setDeadlinePolicy(ThreadPool::DEADLINE_DEMOTE);
+    Recorder recorder(3);
+    pool.async(recorder.record(1));
+    pool.asyncDeadline(recorder.record(2), 0);
+    pool.asyncDeadline(recorder.record(0), 10000);
+    std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    pool.start();
+    bool ok = check(recorder.wait() == std::vector<int>({0, 1, 2}), "错过截止时间的任务降级到普通任务之后");
+    return check(pool.deadlineMissCount() == 1 && pool.deadlineDropCount() == 0, "降级计入错过次数但不计入丢弃") && ok;
+}
+
+//截止时间任务持续排队时，普通任务每隔固定个数被执行一次而不是被饿死
+static bool testFifoInterval()
+{
+    ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+    pool.setDeadlinePolicy(ThreadPool::DEADLINE_RUN, 8);
+    Recorder recorder(101);
+    pool.async(recorder.record(-1));
+    for (int i = 0; i < 100; ++i)
+    {
+        pool.asyncDeadline(recorder.record(i), 10000 + i);
+    }
+    pool.start();
+    auto order = recorder.wait();
+    return check(order.size() == 101 && order[8] == -1, "每执行8个截止时间任务穿插一个普通任务");
+}
+
+int main()
+{
+    bool ok = testOrder();
+    ok = testDrop() && ok;
+    ok = testDemote() && ok;
+    ok = testFifoInterval() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,100 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include "Poller/EventPoller.h"
+#include "Util/DeferredRelease.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//析构时记录所在线程
+class Probe
+{
+public:
+    Probe(std::atomic<bool> &destroyed, std::thread::id &thread) : _destroyed(destroyed), _thread(thread) {}
+
+    ~Probe()
+    {
+        _thread = std::this_thread::get_id();
+        _destroyed = true;
+    }
+
+private:
+    std::atomic<bool> &_destroyed;
+    std::thread::id &_thread;
+};
+
+//在poller线程创建、在其他线程最后释放的对象转回poller线程释放
+static bool testCrossThread(const EventPoller::Ptr &poller)
+{
+    std::atomic<bool> destroyed{false};
+    std::thread::id destroyThread;
+    std::thread::id pollerThread;
+    std::shared_ptr<Probe> probe;
+    auto before = poller->getReleaseStatistic();
+    Semaphore sem;
+    poller->async([&]() {
+        pollerThread = std::this_thread::get_id();
+        probe = makeHomeShared(new Probe(destroyed, destroyThread));
+        sem.post();
+    }, false);
+    sem.wait();
+
+    probe = nullptr;
+    for (int i = 0; i < 100 && !destroyed; ++i)
+    {
+        //每轮事件循环都会释放队列中的对象
+        poller->async([&]() { sem.post(); }, false);
+        sem.wait();
+    }
+    auto after = poller->getReleaseStatistic();
+    bool ok = check(destroyed && destroyThread == pollerThread, "其他线程最后释放的对象在所属线程释放");
+    return check(after._deferred == before._deferred + 1 && after._fallback == before._fallback, "延迟释放计数") && ok;
+}
+
+//队列已满或已关闭时由释放线程直接释放并计入_fallback，回收后可被复用
+static bool testFallbackAndClose()
+{
+    auto queue = ReleaseQueue::obtain(4, nullptr);
+    std::atomic<int> deleted{0};
+    static std::atomic<int> *s_deleted = nullptr;
+    s_deleted = &deleted;
+    auto deleter = [](void *) { ++*s_deleted; };
+    int pushed = 0;
+    for (int i = 0; i < 5; ++i)
+    {
+        pushed += queue->push(nullptr, deleter);
+    }
+    auto statistic = queue->getStatistic();
+    bool ok = check(pushed == 4 && statistic._fallback == 1, "队列已满时计入_fallback");
+    ok = check(queue->drain() == 4 && deleted == 4 && queue->getStatistic()._deferred == 4, "drain释放队列中的对象并计入_deferred") && ok;
+
+    //在以该队列为所属队列的线程中创建对象，关闭后在本线程释放
+    std::atomic<bool> destroyed{false};
+    std::thread::id destroyThread;
+    std::shared_ptr<Probe> probe;
+    std::thread([&]() {
+        ReleaseQueue::current() = queue;
+        probe = makeHomeShared(new Probe(destroyed, destroyThread));
+        ReleaseQueue::current() = nullptr;
+    }).join();
+    queue->close();
+    probe = nullptr;
+    ok = check(destroyed && destroyThread == std::this_thread::get_id() && queue->getStatistic()._fallback == 2, "关闭后释放的对象由释放线程直接释放") && ok;
+
+    ReleaseQueue::recycle(queue);
+    auto reused = ReleaseQueue::obtain(4, nullptr);
+    ok = check(reused == queue && reused->push(nullptr, deleter) && reused->drain() == 1, "回收的队列被复用") && ok;
+    ReleaseQueue::recycle(reused);
+    return ok;
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    bool ok = testCrossThread(poller);
+    ok = testFallbackAndClose() && ok;
+    return ok ? 0 : 1;
+}
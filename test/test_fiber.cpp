@@ -0,0 +1,127 @@
+#include <time.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/socket.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include "Poller/Fiber.h"
+#include "Network/SocketHandler.h"
+#include "Thread/Semaphore.h"
+#include "Thread/CancelToken.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    Semaphore sem;
+    double switchNs = 0;
+
+    //纤程与poller线程之间来回切换，测量单次上下文切换耗时
+    const int switchCount = 1000000;
+    Fiber::Ptr fiber = Fiber::start(poller, [&]() {
+        for (int i = 0; i < switchCount; ++i)
+        {
+            Fiber::suspend();
+        }
+    });
+    poller->async([&]() {
+        auto begin = nowNs();
+        while (!fiber->finished())
+        {
+            fiber->resume();
+        }
+        switchNs = (double)(nowNs() - begin) / (switchCount * 2);
+        std::cout << "纤程上下文切换" << switchCount * 2 << "次，平均每次耗时:" << switchNs << "ns" << std::endl;
+        sem.post();
+    }, false);
+    sem.wait();
+    fiber = nullptr;
+    bool ok = check(switchNs > 0 && switchNs < 100, "单次上下文切换耗时低于100ns");
+
+    //两个纤程通过socketpair以同步写法一问一答
+    int fds[2];
+    socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+    SocketHandler::setNoBlocked(fds[0]);
+    SocketHandler::setNoBlocked(fds[1]);
+
+    const int rounds = 10000;
+    ssize_t echoRead = 0, echoWritten = 0, pingWritten = 0, pingRead = 0;
+    bool pingMatched = true;
+    uint64_t sleepMs = 0, waitMs = 0;
+    int waitRet = -1;
+    Fiber::start(poller, [&]() {
+        char buf[64];
+        for (int i = 0; i < rounds; ++i)
+        {
+            auto size = Fiber::read(fds[1], buf, sizeof(buf));
+            if (size <= 0)
+            {
+                break;
+            }
+            echoRead += size;
+            echoWritten += Fiber::write(fds[1], buf, 4);
+        }
+    });
+    Fiber::start(poller, [&]() {
+        char buf[64];
+        auto begin = nowNs();
+        for (int i = 0; i < rounds; ++i)
+        {
+            pingWritten += Fiber::write(fds[0], "ping", 4);
+            auto size = Fiber::read(fds[0], buf, sizeof(buf));
+            pingRead += size;
+            pingMatched = pingMatched && size == 4 && memcmp(buf, "ping", 4) == 0;
+        }
+        std::cout << "纤程同步收发" << rounds << "次，平均每次往返耗时:" << (nowNs() - begin) / rounds / 1000.0 << "us" << std::endl;
+
+        begin = nowNs();
+        Fiber::sleep(50);
+        sleepMs = (nowNs() - begin) / 1000000;
+        std::cout << "纤程休眠50ms，实际耗时:" << sleepMs << "ms" << std::endl;
+
+        begin = nowNs();
+        waitRet = Fiber::wait(fds[0], PollEventRead, 30);
+        waitMs = (nowNs() - begin) / 1000000;
+        std::cout << "纤程等待可读超时，返回:" << waitRet << "，耗时:" << waitMs << "ms" << std::endl;
+        sem.post();
+    });
+    sem.wait();
+    close(fds[0]);
+    close(fds[1]);
+    ok = check(pingWritten == rounds * 4 && echoRead == rounds * 4 && echoWritten == rounds * 4, "同步读写传输的字节数正确") && ok;
+    ok = check(pingRead == rounds * 4 && pingMatched, "收到的回应内容正确") && ok;
+    //定时器按毫秒时钟到期，与steady_clock相比可能早到1毫秒
+    ok = check(sleepMs >= 45, "休眠接近指定时间") && ok;
+    ok = check(waitRet == 0 && waitMs >= 25, "等待超时返回0") && ok;
+
+    //纤程挂起后调度者恢复自己的令牌，纤程再次恢复后仍持有自己的令牌
+    auto token = CancelToken::create();
+    bool pollerClean = false, fiberKept = false;
+    fiber = Fiber::start(poller, [&]() {
+        Fiber::suspend();
+        CancelToken::Scope scope(token);
+        Fiber::suspend();
+        fiberKept = CancelToken::current() == token;
+        sem.post();
+    });
+    poller->async([&]() {
+        //纤程在令牌作用域内挂起，切回后本线程的令牌不能被其覆盖
+        fiber->resume();
+        pollerClean = !CancelToken::current();
+        CancelToken::Scope scope(CancelToken::create());
+        fiber->resume();
+    }, false);
+    sem.wait();
+    ok = check(pollerClean, "纤程挂起后调度者令牌正确") && ok;
+    ok = check(fiberKept, "恢复后纤程令牌不变") && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,142 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <stdexcept>
+#include "Thread/Future.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/CancelToken.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//设置结果与注册延续函数在两个线程同时进行，延续函数必须恰好执行一次且看到正确的结果
+static bool testSetThenRace()
+{
+    const int rounds = 20000;
+    std::atomic<int> called{0};
+    std::atomic<int> wrong{0};
+    for (int i = 0; i < rounds; ++i)
+    {
+        Promise<int> promise;
+        auto future = promise.getFuture();
+        std::atomic<bool> go{false};
+        std::thread setter([&]() {
+            while (!go)
+            {
+            }
+            promise.setValue(i);
+        });
+        go = true;
+        future.then([&, i](int value) {
+            ++called;
+            if (value != i)
+            {
+                ++wrong;
+            }
+        });
+        setter.join();
+    }
+    return check(called == rounds && wrong == 0, "set与then竞争时延续函数恰好执行一次");
+}
+
+static bool testExecutorThen()
+{
+    auto pool = std::make_shared<ThreadPool>(1);
+    auto tid = std::make_shared<std::thread::id>();
+    auto value = asyncFuture(pool, [tid]() {
+        *tid = std::this_thread::get_id();
+        return 1;
+    }).then(pool, [tid](int value) {
+        //延续函数在指定的执行器中执行
+        return *tid == std::this_thread::get_id() ? value + 1 : -1;
+    }).get();
+    return check(value == 2, "then(executor)在执行器线程中执行");
+}
+
+//在已取消的令牌作用域内设置结果，投递到执行器的延续函数不受影响
+static bool testCanceledProducer()
+{
+    auto pool = std::make_shared<ThreadPool>(1);
+    Promise<int> promise;
+    auto future = promise.getFuture().then(pool, [](int value) {
+        return value + 1;
+    });
+    {
+        auto token = CancelToken::create();
+        token->cancel();
+        CancelToken::Scope scope(token);
+        promise.setValue(1);
+    }
+    int value = 0;
+    try
+    {
+        value = future.get();
+    }
+    catch (std::future_error &)
+    {
+        value = -1;
+    }
+    return check(value == 2, "产生结果的线程令牌已取消时延续函数仍然执行");
+}
+
+static bool testException()
+{
+    bool ok = false;
+    try
+    {
+        asyncFuture(std::make_shared<ThreadPool>(1), []() -> int {
+            throw std::runtime_error("test");
+        }).then([](int value) {
+            return value;
+        }).get();
+    }
+    catch (std::runtime_error &)
+    {
+        ok = true;
+    }
+    bool broken = false;
+    try
+    {
+        Future<int> future;
+        {
+            Promise<int> promise;
+            future = promise.getFuture();
+        }
+        future.get();
+    }
+    catch (std::future_error &ex)
+    {
+        broken = ex.code() == std::future_errc::broken_promise;
+    }
+    return check(ok, "异常沿延续链传递") & check(broken, "Promise未设置结果析构时得到broken_promise");
+}
+
+static bool testWhenAll()
+{
+    auto pool = std::make_shared<ThreadPool>(2);
+    std::vector<Future<int> > futures;
+    for (int i = 0; i < 100; ++i)
+    {
+        futures.emplace_back(asyncFuture(pool, [i]() {
+            return i;
+        }));
+    }
+    auto values = when_all(std::move(futures)).get();
+    bool ok = values.size() == 100;
+    for (size_t i = 0; ok && i < values.size(); ++i)
+    {
+        ok = values[i] == (int)i;
+    }
+    return check(ok, "when_all按原顺序返回结果");
+}
+
+int main()
+{
+    bool ok = testSetThenRace();
+    ok = testExecutorThen() && ok;
+    ok = testCanceledProducer() && ok;
+    ok = testException() && ok;
+    ok = testWhenAll() && ok;
+    return ok ? 0 : 1;
+}
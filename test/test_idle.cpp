@@ -0,0 +1,114 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include "Poller/EventPoller.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//没有其他工作时空闲任务很快执行，执行前取消的不执行
+static bool testIdle(const EventPoller::Ptr &poller)
+{
+    std::atomic<int> executed{0};
+    Semaphore done;
+    poller->onIdle([&]() {
+        ++executed;
+        done.post();
+    });
+    //取消需在poller线程中进行，保证发生在空闲任务执行之前
+    poller->async([&]() {
+        poller->onIdle([&]() { executed += 100; })->cancel();
+    }, false);
+    done.wait();
+    std::this_thread::sleep_for(std::chrono::milliseconds(50));
+    return check(executed == 1, "空闲时执行空闲任务，已取消的不执行");
+}
+
+//任务队列一直非空时推迟，队列清空后才执行
+static bool testPendingTask(const EventPoller::Ptr &poller)
+{
+    const int chain = 1000;
+    std::atomic<int> remain{chain};
+    std::atomic<int> remainAtIdle{-1};
+    Semaphore done;
+    std::function<void()> next = [&]() {
+        //返回前投递下一个，事件循环始终有待执行的任务
+        if (--remain > 0)
+        {
+            poller->async(next, false);
+        }
+    };
+    poller->async([&]() {
+        poller->onIdle([&]() {
+            remainAtIdle = remain.load();
+            done.post();
+        });
+        next();
+    }, false);
+    done.wait();
+    return check(remainAtIdle == 0, "有待执行任务时推迟空闲任务");
+}
+
+//定时任务即将到期时推迟，定时任务停止后才执行
+static bool testPendingTimer(const EventPoller::Ptr &poller)
+{
+    std::atomic<int> ticks{0};
+    std::atomic<int> ticksAtIdle{-1};
+    Semaphore done;
+    poller->async([&]() {
+        poller->startDelayOperation(2, [&]() -> uint64_t {
+            return ++ticks < 50 ? 2 : 0;
+        });
+        poller->onIdle([&]() {
+            ticksAtIdle = ticks.load();
+            done.post();
+        });
+    }, false);
+    done.wait();
+    return check(ticksAtIdle == 50, "定时任务即将到期时推迟空闲任务");
+}
+
+//每轮只在时间预算内执行空闲任务，其余留到下一轮，期间投递的任务不会被长时间阻塞
+static bool testBudget(const EventPoller::Ptr &poller)
+{
+    const int count = 100;
+    std::atomic<int> executed{0};
+    std::atomic<int> executedAtProbe{-1};
+    Semaphore done;
+    poller->setIdlePolicy(5000, 100, 0);
+    poller->async([&]() {
+        for (int i = 0; i < count; ++i)
+        {
+            poller->onIdle([&, i]() {
+                if (i == 0)
+                {
+                    poller->async([&]() { executedAtProbe = executed.load(); }, false);
+                }
+                auto end = getCurrentMicrosecond() + 2000;
+                while (getCurrentMicrosecond() < end)
+                {
+                }
+                if (++executed == count)
+                {
+                    done.post();
+                }
+            });
+        }
+    }, false);
+    done.wait();
+    poller->setIdlePolicy(1000, 50, 10);
+    std::cout << "探测任务执行时已执行的空闲任务数:" << executedAtProbe << std::endl;
+    return check(executedAtProbe > 0 && executedAtProbe < 10, "空闲任务按时间预算分批执行");
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    bool ok = testIdle(poller);
+    ok = testPendingTask(poller) && ok;
+    ok = testPendingTimer(poller) && ok;
+    ok = testBudget(poller) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,69 @@
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <algorithm>
+#include "Thread/ThreadPool.h"
+
+using namespace JCToolKit;
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+static uint64_t threadCpuNs()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &ts);
+    return ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+//每隔intervalUs微秒投递一个小任务，统计从投递到开始执行的延时以及工作线程消耗的CPU时间
+static void bench(const char *name, uint32_t spinCount, uint32_t yieldCount)
+{
+    const int taskCount = 5000;
+    const int intervalUs = 100;
+
+    ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+    pool.setIdleStrategy(spinCount, yieldCount);
+    pool.start();
+
+    std::vector<uint64_t> latency(taskCount);
+    uint64_t cpuBegin = 0, cpuEnd = 0;
+    pool.sync([&]() {
+        cpuBegin = threadCpuNs();
+    });
+
+    auto begin = nowNs();
+    for (int i = 0; i < taskCount; ++i)
+    {
+        auto postTime = nowNs();
+        pool.async([&latency, i, postTime]() {
+            latency[i] = nowNs() - postTime;
+        });
+        std::this_thread::sleep_for(std::chrono::microseconds(intervalUs));
+    }
+    pool.sync([&]() {
+        cpuEnd = threadCpuNs();
+    });
+    auto wall = nowNs() - begin;
+
+    std::sort(latency.begin(), latency.end());
+    std::cout << name
+              << " 延时p50:" << latency[taskCount / 2] / 1000.0 << "us"
+              << " p99:" << latency[taskCount * 99 / 100] / 1000.0 << "us"
+              << " 工作线程CPU占用:" << (cpuEnd - cpuBegin) * 100.0 / wall << "%"
+              << " 自旋占比:" << pool.spinLoad() << "%" << std::endl;
+}
+
+int main()
+{
+    bench("直接休眠        ", 0, 0);
+    bench("自旋2000次      ", 2000, 0);
+    bench("自旋2000+yield100", 2000, 100);
+    bench("自旋20000+yield1000", 20000, 1000);
+    return 0;
+}
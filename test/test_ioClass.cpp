@@ -0,0 +1,170 @@
+#include <vector>
+#include <algorithm>
+#include <iostream>
+#include <fcntl.h>
+#include <unistd.h>
+#include "Poller/EventPoller.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//在poller线程中执行并等待完成
+static void runInPoller(const EventPoller::Ptr &poller, const std::function<void()> &op)
+{
+    Semaphore sem;
+    poller->async([&]() {
+        op();
+        sem.post();
+    }, false);
+    sem.wait();
+}
+
+//普通事件上限只计算普通fd：内部管道每轮都就绪时，每轮仍处理满上限个普通fd，超出的边沿触发事件不丢失
+static bool testBulkLimit(const EventPoller::Ptr &poller)
+{
+    const int fdCount = 10;
+    const int limit = 2;
+    poller->setIOClassLimit(EventPoller::IO_CLASS_BULK, limit);
+    std::vector<int> fds(fdCount * 2);
+    for (int i = 0; i < fdCount; ++i)
+    {
+        if (pipe(&fds[i * 2]) != 0)
+        {
+            return check(false, "创建管道");
+        }
+        fcntl(fds[i * 2], F_SETFL, O_NONBLOCK);
+    }
+
+    //每轮事件循环投递一次的任务记录轮次，使内部管道每轮都有事件
+    int round = 0;
+    std::vector<int> handled(fdCount, 0);
+    std::vector<int> perRound;
+    std::function<void()> tick = [&]() {
+        ++round;
+        if (std::count(handled.begin(), handled.end(), 0) != 0)
+        {
+            poller->async(tick, false);
+        }
+    };
+    runInPoller(poller, [&]() {
+        for (int i = 0; i < fdCount; ++i)
+        {
+            int fd = fds[i * 2];
+            poller->addEvent(fd, PollEventRead, [&, i, fd](int) {
+                char buf[8];
+                while (read(fd, buf, sizeof(buf)) > 0)
+                {
+                }
+                ++handled[i];
+                perRound.resize(std::max<size_t>(perRound.size(), round + 1));
+                ++perRound[round];
+            });
+        }
+    });
+    runInPoller(poller, [&]() {
+        for (int i = 0; i < fdCount; ++i)
+        {
+            if (write(fds[i * 2 + 1], "x", 1) != 1)
+            {
+                handled[i] = -1;
+            }
+        }
+        poller->async(tick, false);
+    });
+
+    bool done = false;
+    while (!done)
+    {
+        runInPoller(poller, [&]() {
+            done = std::count(handled.begin(), handled.end(), 0) == 0;
+        });
+    }
+    int maxPerRound = 0;
+    runInPoller(poller, [&]() {
+        for (int i = 0; i < fdCount; ++i)
+        {
+            poller->deleteEvent(fds[i * 2]);
+        }
+        maxPerRound = perRound.empty() ? 0 : *std::max_element(perRound.begin(), perRound.end());
+    });
+    for (auto fd : fds)
+    {
+        close(fd);
+    }
+    poller->setIOClassLimit(EventPoller::IO_CLASS_BULK, 0);
+
+    std::cout << "每轮最多处理的普通fd个数:" << maxPerRound << std::endl;
+    bool ok = check(std::count(handled.begin(), handled.end(), 1) == fdCount, "超出上限的边沿触发事件留到下一轮且只处理一次");
+    return check(maxPerRound == limit, "内部管道不占用普通事件上限") && ok;
+}
+
+//大量普通fd与一个高优先级fd同时可读，高优先级fd最先被处理
+int main()
+{
+    const int bulkCount = 200;
+    auto poller = EventPollerPool::Instance().getPoller();
+    //限制每轮处理的普通fd事件数，普通fd需多轮才能处理完
+    poller->setIOClassLimit(EventPoller::IO_CLASS_BULK, 16);
+
+    std::vector<int> order;
+    std::vector<int> fds((bulkCount + 1) * 2);
+    for (int i = 0; i <= bulkCount; ++i)
+    {
+        if (pipe(&fds[i * 2]) != 0)
+        {
+            return check(false, "创建管道") ? 0 : 1;
+        }
+        fcntl(fds[i * 2], F_SETFL, O_NONBLOCK);
+    }
+    runInPoller(poller, [&]() {
+        for (int i = 0; i <= bulkCount; ++i)
+        {
+            int fd = fds[i * 2];
+            poller->addEvent(fd, PollEventRead, [&order, i, fd](int) {
+                char buf[8];
+                while (read(fd, buf, sizeof(buf)) > 0)
+                {
+                }
+                order.emplace_back(i);
+            }, i == bulkCount ? EventPoller::IO_CLASS_HIGH : EventPoller::IO_CLASS_BULK);
+        }
+    });
+
+    //在poller线程中一次写入，所有fd在同一轮事件循环中同时就绪；高优先级fd最后写入
+    runInPoller(poller, [&]() {
+        for (int i = 0; i <= bulkCount; ++i)
+        {
+            if (write(fds[i * 2 + 1], "x", 1) != 1)
+            {
+                order.emplace_back(-1);
+            }
+        }
+    });
+
+    std::vector<int> result;
+    while (result.size() < (size_t)bulkCount + 1)
+    {
+        runInPoller(poller, [&]() {
+            result = order;
+        });
+    }
+
+    runInPoller(poller, [&]() {
+        for (int i = 0; i <= bulkCount; ++i)
+        {
+            poller->deleteEvent(fds[i * 2]);
+        }
+    });
+    for (auto fd : fds)
+    {
+        close(fd);
+    }
+    poller->setIOClassLimit(EventPoller::IO_CLASS_BULK, 0);
+
+    std::cout << "已处理fd个数:" << result.size() << " 高优先级fd处理位置:" << (result.empty() ? -1 : (int)(std::find(result.begin(), result.end(), bulkCount) - result.begin())) << std::endl;
+    bool ok = check(result.size() == (size_t)bulkCount + 1, "所有fd都被处理");
+    ok = check(!result.empty() && result.front() == bulkCount, "高优先级fd先于普通fd处理") && ok;
+    ok = testBulkLimit(poller) && ok;
+    return ok ? 0 : 1;
+}
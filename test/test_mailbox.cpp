@@ -0,0 +1,54 @@
+#include <vector>
+#include <iostream>
+#include "Poller/EventPoller.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//同池poller线程交替使用async、asyncBatch、asyncAdmit投递，目标poller按投递顺序执行
+int main()
+{
+    EventPollerPool::setPoolSize(2);
+    EventPollerPool::Instance().resize(2);
+    std::vector<EventPoller::Ptr> pollers;
+    EventPollerPool::Instance().for_each([&](const OperationExecutor::Ptr &executor) {
+        pollers.emplace_back(std::dynamic_pointer_cast<EventPoller>(executor));
+    });
+    if (pollers.size() < 2)
+    {
+        return check(false, "创建两个poller") ? 0 : 1;
+    }
+
+    auto source = pollers[0];
+    auto target = pollers[1];
+    target->setAdmissionLimit(100000);
+    const int rounds = 1000;
+    std::vector<int> order;
+    Semaphore done;
+    source->async([&]() {
+        int seq = 0;
+        for (int i = 0; i < rounds; ++i)
+        {
+            target->async([&order, seq]() { order.emplace_back(seq); }, false);
+            ++seq;
+            std::vector<OperationFunction> batch;
+            for (int j = 0; j < 3; ++j, ++seq)
+            {
+                batch.emplace_back([&order, seq]() { order.emplace_back(seq); });
+            }
+            target->asyncBatch(std::move(batch), false);
+            target->asyncAdmit([&order, seq]() { order.emplace_back(seq); }, EventPoller::ADMIT_NORMAL, nullptr, false);
+            ++seq;
+        }
+        target->async([&]() { done.post(); }, false);
+    }, false);
+    done.wait();
+
+    bool ordered = order.size() == (size_t)rounds * 5;
+    for (size_t i = 0; ordered && i < order.size(); ++i)
+    {
+        ordered = order[i] == (int)i;
+    }
+    return check(ordered, "同一来源poller的任务按投递顺序执行") ? 0 : 1;
+}
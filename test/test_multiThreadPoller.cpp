@@ -0,0 +1,171 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <unistd.h>
+#include "Poller/MultiThreadPoller.h"
+#include "Network/SocketHandler.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//多个fd同时有数据，同一fd的回调不并发，所有数据都被读到
+static bool testFdEvent(const MultiThreadPoller::Ptr &poller)
+{
+    const int fdCount = 16;
+    const int bytesPerFd = 1000;
+    std::vector<int> fds(fdCount * 2);
+    std::vector<std::atomic<bool> > inside(fdCount);
+    std::atomic<int> overlap{0};
+    std::atomic<int> received{0};
+    Semaphore done;
+    for (int i = 0; i < fdCount; ++i)
+    {
+        if (pipe(&fds[i * 2]) != 0)
+        {
+            return check(false, "创建管道");
+        }
+        SocketHandler::setNoBlocked(fds[i * 2]);
+        inside[i] = false;
+        int fd = fds[i * 2];
+        poller->addEvent(fd, PollEventRead | PollEventLT, [&, i, fd](int event) {
+            if (inside[i].exchange(true))
+            {
+                ++overlap;
+            }
+            char buf[64];
+            auto size = read(fd, buf, sizeof(buf));
+            //延长回调时间，使同一fd的后续数据在回调期间到达
+            std::this_thread::sleep_for(std::chrono::microseconds(50));
+            inside[i] = false;
+            if (size > 0 && (received += size) == fdCount * bytesPerFd)
+            {
+                done.post();
+            }
+        });
+    }
+
+    std::vector<std::thread> writers;
+    for (int i = 0; i < fdCount; ++i)
+    {
+        writers.emplace_back([&, i]() {
+            for (int j = 0; j < bytesPerFd; ++j)
+            {
+                while (write(fds[i * 2 + 1], "x", 1) != 1)
+                {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    for (auto &writer : writers)
+    {
+        writer.join();
+    }
+    done.wait();
+    for (int i = 0; i < fdCount; ++i)
+    {
+        poller->deleteEvent(fds[i * 2]);
+        close(fds[i * 2]);
+        close(fds[i * 2 + 1]);
+    }
+    return check(overlap == 0, "同一fd的回调不并发执行") & check(received == fdCount * bytesPerFd, "所有fd的数据都被读到");
+}
+
+//一次性与重复的定时任务都按时执行
+static bool testTimer(const MultiThreadPoller::Ptr &poller)
+{
+    std::atomic<int> once{0};
+    std::atomic<int> repeat{0};
+    Semaphore done;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 1; i <= 10; ++i)
+    {
+        poller->startDelayOperation(i * 5, [&]() -> uint64_t {
+            ++once;
+            return 0;
+        });
+    }
+    poller->startDelayOperation(10, [&]() -> uint64_t {
+        if (++repeat == 5)
+        {
+            done.post();
+            return 0;
+        }
+        return 10;
+    });
+    done.wait();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    return check(once == 10 && repeat == 5 && elapsed >= 45, "定时任务按时执行");
+}
+
+//其他线程投递的异步任务全部执行
+static bool testAsync(const MultiThreadPoller::Ptr &poller)
+{
+    const int producers = 4;
+    const int count = 5000;
+    std::atomic<int> executed{0};
+    Semaphore done;
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i)
+    {
+        threads.emplace_back([&]() {
+            for (int j = 0; j < count; ++j)
+            {
+                poller->async([&]() {
+                    if (++executed == producers * count)
+                    {
+                        done.post();
+                    }
+                }, false);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    done.wait();
+    return check(executed == producers * count, "异步任务全部执行");
+}
+
+//有任务在途时反复析构，所有线程都能退出，未执行的任务在析构时执行
+static bool testDestruction()
+{
+    std::atomic<int> posted{0};
+    std::atomic<int> executed{0};
+    for (int i = 0; i < 200; ++i)
+    {
+        auto poller = MultiThreadPoller::create(4);
+        for (int j = 0; j < 10; ++j)
+        {
+            ++posted;
+            poller->async([&]() { ++executed; }, false);
+        }
+        poller->startDelayOperation(1, [&]() -> uint64_t { return 1; });
+    }
+    return check(executed == posted, "析构时线程全部退出且任务全部执行");
+}
+
+int main()
+{
+    //析构死锁时直接失败退出，而不是一直挂起
+    std::thread([]() {
+        std::this_thread::sleep_for(std::chrono::seconds(60));
+        check(false, "测试超时");
+        _exit(1);
+    }).detach();
+
+    bool ok;
+    {
+        auto poller = MultiThreadPoller::create(4);
+        ok = testFdEvent(poller);
+        ok = testTimer(poller) && ok;
+        ok = testAsync(poller) && ok;
+    }
+    ok = testDestruction() && ok;
+    return ok ? 0 : 1;
+}
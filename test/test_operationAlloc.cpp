@@ -0,0 +1,82 @@
+#include <atomic>
+#include <thread>
+#include <iostream>
+#include <stdlib.h>
+#include <new>
+#include "Thread/ThreadPool.h"
+#include "Poller/EventPoller.h"
+
+using namespace JCToolKit;
+
+//统计全局内存分配次数
+static std::atomic<uint64_t> s_alloc_count(0);
+
+void *operator new(size_t size)
+{
+    ++s_alloc_count;
+    if (void *ptr = malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+static const int kTaskCount = 100000;
+
+int main()
+{
+    {
+        //其他线程向ThreadPool投递任务
+        ThreadPool pool(1, ThreadPool::PRIORITY_HIGHEST, false);
+        std::atomic<int> count(0);
+        auto begin = s_alloc_count.load();
+        for (int i = 0; i < kTaskCount; ++i)
+        {
+            pool.async([&count]() {
+                ++count;
+            });
+        }
+        auto end = s_alloc_count.load();
+        std::cout << "ThreadPool::async 每个任务内存分配次数:" << (double)(end - begin) / kTaskCount << std::endl;
+        pool.start();
+        while (count.load() != kTaskCount)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        }
+    }
+
+    {
+        //EventPoller线程内向自己投递任务(例如分批处理、延后执行)，
+        //第一轮执行完毕后任务对象回到线程本地缓存，第二轮可直接复用
+        auto poller = EventPollerPool::Instance().getPoller();
+        const int taskCount = 1000;
+        int count = 0;
+        uint64_t allocs = 0;
+        for (int i = 0; i < 2; ++i)
+        {
+            poller->sync([&]() {
+                auto begin = s_alloc_count.load();
+                for (int j = 0; j < taskCount; ++j)
+                {
+                    poller->async([&count]() {
+                        ++count;
+                    }, false);
+                }
+                allocs = s_alloc_count.load() - begin;
+            });
+            poller->sync([]() {});
+        }
+        std::cout << "EventPoller线程内async 每个任务内存分配次数:" << (double)allocs / taskCount << std::endl;
+    }
+    return 0;
+}
@@ -0,0 +1,94 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include "Thread/Pipeline.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//多线程处理的有序阶段按输入顺序交付，不调用close直接wait也能结束
+static bool testOrdered()
+{
+    const int total = 1000;
+    std::vector<int> output;
+    auto pipeline = Pipeline<int>::create(4, 4);
+    pipeline->map<int>("square", 4, PIPELINE_ORDERED, [](int &value) {
+        //各批次耗时不同，完成顺序与输入顺序不一致
+        if (value % 7 == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        return value * value;
+    }).sink("collect", 1, PIPELINE_ORDERED, [&](std::vector<int> &batch) {
+        output.insert(output.end(), batch.begin(), batch.end());
+    });
+    for (int i = 0; i < total; ++i)
+    {
+        pipeline->push(i);
+    }
+    pipeline->wait();
+
+    bool ordered = (int)output.size() == total;
+    for (size_t i = 0; ordered && i < output.size(); ++i)
+    {
+        ordered = output[i] == (int)(i * i);
+    }
+    return check(ordered, "并行度大于1的有序阶段按输入顺序输出");
+}
+
+//最后一个阶段阻塞时，第一阶段输入队列填满后push阻塞
+static bool testBackpressure()
+{
+    const int total = 10;
+    Semaphore release;
+    std::atomic<int> pushed{0};
+    std::atomic<int> consumed{0};
+    auto pipeline = Pipeline<int>::create(1, 2);
+    pipeline->source().sink("block", 1, PIPELINE_UNORDERED, [&](std::vector<int> &batch) {
+        release.wait();
+        consumed += batch.size();
+    });
+    std::thread producer([&]() {
+        for (int i = 0; i < total; ++i)
+        {
+            pipeline->push(i);
+            ++pushed;
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(100));
+    //一批在处理中，队列中缓存两批
+    int blockedAt = pushed;
+    release.post(total);
+    producer.join();
+    pipeline->wait();
+    std::cout << "sink阻塞时成功push的个数:" << blockedAt << std::endl;
+    return check(blockedAt == 3, "队列满时push阻塞") & check(consumed == total, "放行后全部数据被处理");
+}
+
+//未攒满一批的数据在close/wait时仍会被处理
+static bool testPartialBatch()
+{
+    std::atomic<int> consumed{0};
+    auto pipeline = Pipeline<int>::create(100, 4);
+    pipeline->source().sink("count", 2, PIPELINE_UNORDERED, [&](std::vector<int> &batch) {
+        consumed += batch.size();
+    });
+    for (int i = 0; i < 7; ++i)
+    {
+        pipeline->push(i);
+    }
+    pipeline->close();
+    pipeline->wait();
+    return check(consumed == 7, "close后wait处理未攒满的批次");
+}
+
+int main()
+{
+    bool ok = testOrdered();
+    ok = testBackpressure() && ok;
+    ok = testPartialBatch() && ok;
+    return ok ? 0 : 1;
+}
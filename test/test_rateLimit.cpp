@@ -0,0 +1,76 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <iostream>
+#include "Thread/RateLimitExecutor.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//令牌桶按给定时间点计算，不依赖真实时钟
+static bool testTokenBucket()
+{
+    TokenBucket bucket;
+    bucket.setRate(100, 10);
+    uint64_t now = getCurrentMicrosecond();
+    int consumed = 0;
+    while (bucket.available(1, now) && consumed < 100)
+    {
+        bucket.consume(1);
+        ++consumed;
+    }
+    bool ok = check(consumed == 10, "初始可突发消耗桶容量个令牌");
+    //每秒100个，即每10毫秒一个
+    ok = check(bucket.waitTime(1, now) > 9000 && bucket.waitTime(1, now) <= 10001, "令牌耗尽后的等待时间") && ok;
+    now += 50 * 1000;
+    consumed = 0;
+    while (bucket.available(1, now) && consumed < 100)
+    {
+        bucket.consume(1);
+        ++consumed;
+    }
+    ok = check(consumed == 5, "50毫秒后恢复5个令牌") && ok;
+    now += 10 * 1000 * 1000;
+    consumed = 0;
+    while (bucket.available(1, now) && consumed < 100)
+    {
+        bucket.consume(1);
+        ++consumed;
+    }
+    return check(consumed == 10, "长时间空闲后令牌不超过桶容量") && ok;
+}
+
+//超出突发量的任务按速率释放，总耗时约等于(总数-突发量)/速率
+static bool testExecutorRate()
+{
+    const int total = 120;
+    auto pool = std::make_shared<ThreadPool>(1);
+    auto executor = std::make_shared<RateLimitExecutor>(pool);
+    executor->setTaskRate(200, 20);
+    std::atomic<int> executed{0};
+    Semaphore done;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < total; ++i)
+    {
+        executor->async([&]() {
+            if (++executed == total)
+            {
+                done.post();
+            }
+        });
+    }
+    done.wait();
+    auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "执行" << total << "个任务耗时:" << elapsed << "ms 限速排队任务数:" << executor->throttledCount() << std::endl;
+    //理论耗时500毫秒，定时精度为毫秒级，留出余量
+    return check(elapsed >= 400 && elapsed <= 1000, "任务按令牌桶速率执行") & check(executor->throttledCount() == total - 20, "突发量之外的任务都经过排队");
+}
+
+int main()
+{
+    bool ok = testTokenBucket();
+    ok = testExecutorRate() && ok;
+    return ok ? 0 : 1;
+}
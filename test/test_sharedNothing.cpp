@@ -0,0 +1,106 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include "Poller/EventPoller.h"
+#include "Network/SocketHandler.h"
+#include "Network/Buffer.h"
+
+using namespace JCToolKit;
+
+static uint64_t nowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+//在前threads个poller上同时执行durationMs毫秒的典型工作：查dns缓存、查当前poller、创建释放带计数的Buffer
+static double bench(const std::vector<EventPoller::Ptr> &pollers, size_t threads, uint64_t durationMs)
+{
+    std::atomic<uint64_t> total{0};
+    std::atomic<size_t> ready{0};
+    std::atomic<bool> go{false};
+    Semaphore done;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        pollers[i]->async([&]() {
+            ++ready;
+            while (!go)
+            {
+                std::this_thread::yield();
+            }
+            uint64_t count = 0;
+            auto end = nowNs() + durationMs * 1000000;
+            sockaddr addr;
+            while (nowNs() < end)
+            {
+                for (int j = 0; j < 64; ++j, ++count)
+                {
+                    SocketHandler::getDomainIP("127.0.0.1", 80, addr);
+                    EventPoller::getCurrentPoller();
+                    BufferRaw::create();
+                }
+            }
+            total += count;
+            done.post();
+        }, false);
+    }
+    while (ready < threads)
+    {
+        std::this_thread::yield();
+    }
+    go = true;
+    for (size_t i = 0; i < threads; ++i)
+    {
+        done.wait();
+    }
+    return total * 1000.0 / durationMs;
+}
+
+int main()
+{
+    size_t maxThreads = std::thread::hardware_concurrency();
+    if (maxThreads > 64)
+    {
+        maxThreads = 64;
+    }
+    EventPollerPool::setPoolSize(maxThreads);
+    EventPollerPool::setSharedNothing();
+    //poller按需创建，测试前一次性创建到上限
+    EventPollerPool::Instance().resize(maxThreads);
+
+    std::vector<EventPoller::Ptr> pollers;
+    EventPollerPool::Instance().for_each([&](const OperationExecutor::Ptr &executor) {
+        pollers.emplace_back(std::dynamic_pointer_cast<EventPoller>(executor));
+    });
+
+    if (maxThreads < 2)
+    {
+        std::cout << "只有一个CPU核心，无法测量多核扩展性" << std::endl;
+    }
+
+    //同一组poller分别在共享dns缓存与按线程隔离下运行，对比多核扩展性
+    double efficiency[2] = {0, 0};
+    for (int perThread = 0; perThread < 2; ++perThread)
+    {
+        SocketHandler::setDNSCachePerThread(perThread);
+        std::cout << (perThread ? "无共享模式:" : "共享模式:") << std::endl;
+        double base = 0;
+        for (size_t threads = 1; threads <= maxThreads; threads = (threads < maxThreads && threads * 2 > maxThreads) ? maxThreads : threads * 2)
+        {
+            auto ops = bench(pollers, threads, 300);
+            if (threads == 1)
+            {
+                base = ops;
+            }
+            std::cout << "  线程数:" << threads
+                      << " 吞吐:" << (uint64_t)ops << "次/秒"
+                      << " 加速比:" << ops / base
+                      << " 扩展效率:" << ops / base / threads * 100 << "%" << std::endl;
+            efficiency[perThread] = ops / base / threads * 100;
+        }
+    }
+    //线程数最多时两种模式的扩展效率，即每个核心相对单线程的吞吐比例
+    std::cout << maxThreads << "线程扩展效率 共享模式:" << efficiency[0] << "% 无共享模式:" << efficiency[1] << "%" << std::endl;
+    return 0;
+}
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <thread>
+#include <vector>
+#include <string>
+#include <iostream>
+#include "Thread/Strand.h"
+#include "Thread/ThreadPool.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//多个线程同时向同一个Strand投递，任务不能并发执行，且每个投递线程的任务保持顺序
+static bool testStrandContention(const std::shared_ptr<ThreadPool> &pool)
+{
+    const int producers = 8;
+    const int count = 20000;
+    auto strand = std::make_shared<Strand>(pool, 16);
+    std::atomic<bool> inside{false};
+    std::atomic<int> overlap{0};
+    std::atomic<int> executed{0};
+    std::vector<int> last(producers, -1);
+    bool ordered = true;
+    Semaphore done;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < producers; ++i)
+    {
+        threads.emplace_back([&, i]() {
+            for (int j = 0; j < count; ++j)
+            {
+                strand->async([&, i, j]() {
+                    if (inside.exchange(true))
+                    {
+                        ++overlap;
+                    }
+                    //串行执行，无需加锁
+                    if (j != last[i] + 1)
+                    {
+                        ordered = false;
+                    }
+                    last[i] = j;
+                    inside = false;
+                    if (++executed == producers * count)
+                    {
+                        done.post();
+                    }
+                }, false);
+            }
+        });
+    }
+    for (auto &thread : threads)
+    {
+        thread.join();
+    }
+    done.wait();
+    return check(overlap == 0, "Strand任务不并发执行") & check(ordered, "同一投递线程的任务保持顺序");
+}
+
+//相同key串行，不同key可在多个线程上并行
+static bool testKeyedExecutor(const std::shared_ptr<ThreadPool> &pool)
+{
+    const int keys = 16;
+    const int count = 5000;
+    KeyedExecutor<std::string> executor(pool, 8);
+    std::vector<std::atomic<bool> > inside(keys);
+    std::vector<int> last(keys, -1);
+    std::atomic<int> overlap{0};
+    std::atomic<int> executed{0};
+    bool ordered = true;
+    Semaphore done;
+    for (auto &flag : inside)
+    {
+        flag = false;
+    }
+    for (int j = 0; j < count; ++j)
+    {
+        for (int k = 0; k < keys; ++k)
+        {
+            executor.async("key" + std::to_string(k), [&, k, j]() {
+                if (inside[k].exchange(true))
+                {
+                    ++overlap;
+                }
+                if (j != last[k] + 1)
+                {
+                    ordered = false;
+                }
+                last[k] = j;
+                inside[k] = false;
+                if (++executed == keys * count)
+                {
+                    done.post();
+                }
+            }, false);
+        }
+    }
+    done.wait();
+    return check(overlap == 0 && ordered, "KeyedExecutor同key任务串行且有序");
+}
+
+int main()
+{
+    //Strand的最后一个引用可能在工作线程中释放，线程池需由主线程持有并析构
+    auto pool = std::make_shared<ThreadPool>(4);
+    bool ok = testStrandContention(pool);
+    ok = testKeyedExecutor(pool) && ok;
+    return ok ? 0 : 1;
+}
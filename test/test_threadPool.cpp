@@ -1,12 +1,27 @@
-
 #include <signal.h>
 #include <functional>
 #include <atomic>
 #include <thread>
+#include <vector>
 #include <iostream>
 #include "Util/Ticker.h"
 #include "Thread/ThreadPool.h"
 
+//等待线程池执行完所有任务，每秒打印一次执行速度
+static void waitForDone(std::atomic_size_t &count)
+{
+    uint64_t  lastCount = 0 ,currentCount = 1;
+    while (true){
+        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
+        currentCount = count.load();
+        std::cout << "每秒执行任务数:" << currentCount - lastCount << std::endl;
+        if(currentCount - lastCount == 0){
+            break;
+        }
+        lastCount = currentCount;
+    }
+}
+
 int main()
 {
     signal(SIGINT, [](int) {
@@ -24,20 +39,37 @@ int main()
            }
         });
     }
-    std::cout << "1000万任务入队耗时:" << ticker.elapsedTime() << "ms" << std::endl;
-    uint64_t  lastCount = 0 ,currentCount = 1;
+    auto singleTime = ticker.elapsedTime();
+    std::cout << "1000万任务入队耗时:" << singleTime << "ms" << std::endl;
     ticker.resetTime();
 
     pool.start();
-    while (true){
-        std::this_thread::sleep_for(std::chrono::milliseconds(1000));
-        currentCount = count.load();
-        std::cout << "每秒执行任务数:" << currentCount - lastCount << std::endl;
-        if(currentCount - lastCount == 0){
-            break;
+    waitForDone(count);
+
+    //批量入队，每批1万个任务，对比逐个入队的耗时
+    JCToolKit::ThreadPool batchPool(1,JCToolKit::ThreadPool::PRIORITY_HIGHEST,false);
+    std::atomic_size_t batchCount(0);
+
+    ticker.resetTime();
+    for (int i = 0; i < 1000; ++i){
+        std::vector<JCToolKit::OperationFunction> operations;
+        operations.reserve(10000);
+        for (int j = 0; j < 10000; ++j){
+            operations.emplace_back([&](){
+                if(++batchCount >= 1000*10000){
+                    std::cout << "批量执行1000万任务总共耗时:" << ticker.elapsedTime() << "ms" << std::endl;
+                }
+            });
         }
-        lastCount = currentCount; 
+        batchPool.asyncBatch(std::move(operations), true, true);
     }
+    auto batchTime = ticker.elapsedTime();
+    std::cout << "1000万任务批量入队耗时:" << batchTime << "ms" << std::endl;
+    std::cout << "逐个入队/批量入队耗时比:" << (batchTime ? (double)singleTime / batchTime : 0) << std::endl;
+    ticker.resetTime();
+
+    batchPool.start();
+    waitForDone(batchCount);
     return 0;
 
-}
\ No newline at end of file
+}
@@ -0,0 +1,148 @@
+#include <atomic>
+#include <memory>
+#include <iostream>
+#include <stdlib.h>
+#include <new>
+#include "Util/UniqueFunction.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//统计全局内存分配次数
+static std::atomic<uint64_t> s_alloc_count(0);
+
+void *operator new(size_t size)
+{
+    ++s_alloc_count;
+    if (void *ptr = malloc(size ? size : 1))
+    {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void *ptr) noexcept
+{
+    free(ptr);
+}
+
+void operator delete(void *ptr, size_t) noexcept
+{
+    free(ptr);
+}
+
+//析构时计数
+class Probe
+{
+public:
+    Probe(int value, int &destroyed) : _value(value), _destroyed(destroyed) {}
+
+    ~Probe()
+    {
+        ++_destroyed;
+    }
+
+    int value() const
+    {
+        return _value;
+    }
+
+private:
+    int _value;
+    int &_destroyed;
+};
+
+//只可移动的可调用对象
+class MoveOnlyCall
+{
+public:
+    MoveOnlyCall(std::unique_ptr<Probe> probe) : _probe(std::move(probe)) {}
+
+    int operator()() const
+    {
+        return _probe->value();
+    }
+
+private:
+    std::unique_ptr<Probe> _probe;
+};
+
+//指定大小的捕获数据
+template <size_t Size>
+class Payload
+{
+public:
+    unsigned char data[Size];
+};
+
+//捕获unique_ptr等只可移动的对象，移动后源对象为空，析构时释放捕获的对象
+static bool testMoveOnly()
+{
+    int destroyed = 0;
+    bool ok = true;
+    {
+        std::unique_ptr<Probe> probe(new Probe(42, destroyed));
+        unique_function<int()> func(MoveOnlyCall(std::move(probe)));
+        ok = check(func && func() == 42, "捕获只可移动对象并调用") && ok;
+
+        unique_function<int()> moved(std::move(func));
+        ok = check(!func && moved && moved() == 42, "移动构造后源对象为空") && ok;
+
+        unique_function<int()> assigned;
+        assigned = std::move(moved);
+        ok = check(!moved && assigned() == 42 && destroyed == 0, "移动赋值后捕获的对象仍然存活") && ok;
+
+        assigned = nullptr;
+        ok = check(!assigned && destroyed == 1, "置空时释放捕获的对象") && ok;
+    }
+
+    std::function<void()> empty;
+    unique_function<void()> fromEmpty(empty);
+    bool threw = false;
+    try
+    {
+        fromEmpty();
+    }
+    catch (std::bad_function_call &)
+    {
+        threw = true;
+    }
+    return check(!fromEmpty && threw, "空的std::function视为空，调用时抛出异常") && ok;
+}
+
+//不超过64字节的捕获直接存放在内部缓存中，构造、移动、调用都不分配内存；超出时分配一次
+static bool testInline()
+{
+    Payload<64> small = {};
+    small.data[63] = 7;
+    auto begin = s_alloc_count.load();
+    int result;
+    {
+        unique_function<int()> func([small]() { return (int)small.data[63]; });
+        unique_function<int()> moved(std::move(func));
+        unique_function<int()> assigned;
+        assigned = std::move(moved);
+        result = assigned();
+    }
+    auto inlineAllocs = s_alloc_count.load() - begin;
+    bool ok = check(result == 7 && inlineAllocs == 0, "64字节的捕获存放在内部缓存中，不分配内存");
+
+    Payload<72> large = {};
+    large.data[71] = 9;
+    begin = s_alloc_count.load();
+    {
+        unique_function<int()> func([large]() { return (int)large.data[71]; });
+        unique_function<int()> moved(std::move(func));
+        result = moved();
+    }
+    auto heapAllocs = s_alloc_count.load() - begin;
+    std::cout << "64字节捕获分配次数:" << inlineAllocs << " 72字节捕获分配次数:" << heapAllocs << std::endl;
+    return check(result == 9 && heapAllocs == 1, "超过64字节的捕获在堆上分配一次，移动时不再分配") && ok;
+}
+
+int main()
+{
+    bool ok = testMoveOnly();
+    ok = testInline() && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,109 @@
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <vector>
+#include <iostream>
+#include <unistd.h>
+#include "Poller/EventPoller.h"
+#include "Network/SocketHandler.h"
+#include "Thread/Semaphore.h"
+#include "TestCheck.h"
+
+using namespace JCToolKit;
+
+//让出的后续任务排在已就绪的网络事件回调之后执行
+static bool testOrder(const EventPoller::Ptr &poller)
+{
+    int fds[2];
+    if (pipe(fds) != 0)
+    {
+        return check(false, "创建管道");
+    }
+    SocketHandler::setNoBlocked(fds[0]);
+    std::vector<int> order;
+    Semaphore done;
+    poller->addEvent(fds[0], PollEventRead, [&](int) {
+        char buf[16];
+        if (read(fds[0], buf, sizeof(buf)) > 0)
+        {
+            order.emplace_back(1);
+        }
+    });
+
+    //先阻塞poller线程，使管道可读与投递的任务在同一轮事件循环中被收取
+    Semaphore blocked;
+    Semaphore release;
+    poller->async([&]() {
+        blocked.post();
+        release.wait();
+    }, false);
+    blocked.wait();
+    poller->async([&]() {
+        order.emplace_back(0);
+        poller->yield([&]() {
+            order.emplace_back(2);
+            done.post();
+        });
+    }, false);
+    if (write(fds[1], "x", 1) != 1)
+    {
+        release.post();
+        return check(false, "写入管道");
+    }
+    release.post();
+    done.wait();
+
+    Semaphore removed;
+    poller->deleteEvent(fds[0], [&](bool) { removed.post(); });
+    removed.wait();
+    close(fds[0]);
+    close(fds[1]);
+    auto index = [&](int value) {
+        for (size_t i = 0; i < order.size(); ++i)
+        {
+            if (order[i] == value)
+            {
+                return (int)i;
+            }
+        }
+        return -1;
+    };
+    return check(order.size() == 3 && index(1) >= 0 && index(2) > index(1), "后续任务在已就绪的网络事件之后执行");
+}
+
+//本轮执行超过时间预算后shouldYield返回true，让出后的后续任务获得新的时间预算
+static bool testBudget(const EventPoller::Ptr &poller)
+{
+    const uint64_t budgetUs = 2000;
+    poller->setYieldBudget(budgetUs);
+    std::atomic<bool> freshAtStart{false};
+    std::atomic<uint64_t> elapsedUs{0};
+    std::atomic<bool> freshAfterYield{false};
+    Semaphore done;
+    poller->async([&]() {
+        auto start = getCurrentMicrosecond();
+        freshAtStart = !poller->shouldYield();
+        while (!poller->shouldYield())
+        {
+        }
+        elapsedUs = getCurrentMicrosecond() - start;
+        poller->yield([&]() {
+            freshAfterYield = !poller->shouldYield();
+            done.post();
+        });
+    }, false);
+    done.wait();
+    poller->setYieldBudget(5000);
+    std::cout << "shouldYield返回true前的耗时(微秒):" << elapsedUs << std::endl;
+    bool ok = check(freshAtStart && elapsedUs > 0 && elapsedUs <= budgetUs * 10, "超过时间预算后shouldYield返回true");
+    ok = check(freshAfterYield, "让出后的后续任务获得新的时间预算") && ok;
+    return check(!poller->shouldYield(), "非poller线程调用shouldYield返回false") && ok;
+}
+
+int main()
+{
+    auto poller = EventPollerPool::Instance().getPoller();
+    bool ok = testOrder(poller);
+    ok = testBudget(poller) && ok;
+    return ok ? 0 : 1;
+}